@@ -0,0 +1,131 @@
+// Random 4 KiB reads from a temporary file, through io_uring and through blocking reads on pool workers,
+// with the same number of reads (the queue depth) in flight in both cases.
+// Usage: bench_file_ops [file size in MiB] [number of reads] [number of threads]
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <latch>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "file_ops.h"
+#include "threadpool.h"
+
+namespace {
+
+constexpr std::size_t block_size = 4096;
+
+std::size_t arg(int argc, char** argv, int idx, std::size_t def)
+{
+    return idx < argc ? std::strtoull(argv[idx], nullptr, 10) : def;  // NOLINT(cppcoreguidelines-pro-bounds-*)
+}
+
+bool create_file(const std::string& path, std::size_t size)
+{
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (fd < 0) {
+        return false;
+    }
+
+    const std::vector<char> chunk(1U << 20U, 'x');
+    bool ok = true;
+    for (std::size_t written = 0; ok && written < size; written += chunk.size()) {
+        ok = write(fd, chunk.data(), chunk.size()) == static_cast<ssize_t>(chunk.size());
+    }
+
+    ok = ok && fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+void run(wwa::thread_pool& pool, const wwa::file_ops::options& opts, int fd, std::size_t size, std::size_t reads)
+{
+    wwa::file_ops ops(pool, opts);
+    if (opts.use_io_uring && !ops.uses_io_uring()) {
+        std::printf("io_uring: not available\n");  // NOLINT(cppcoreguidelines-pro-type-vararg)
+        return;
+    }
+
+    std::mt19937_64 rng(42);  // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    std::uniform_int_distribution<std::size_t> block(0, size / block_size - 1);
+    std::vector<std::uint64_t> offsets(reads);
+    for (auto& offset : offsets) {
+        offset = block(rng) * block_size;
+    }
+
+    // Each slot keeps one read in flight and issues the next one from its completion, once its buffer is free
+    const auto slots = std::min<std::size_t>(opts.queue_depth, reads);
+    std::vector<char> buffers(slots * block_size);
+    std::latch done(static_cast<std::ptrdiff_t>(reads));
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> failed{0};
+
+    std::function<void(char*)> issue = [&](char* buf) {
+        const auto i = next.fetch_add(1U, std::memory_order_relaxed);
+        if (i >= reads) {
+            return;
+        }
+
+        ops.read(fd, buf, block_size, offsets[i], [&issue, &done, &failed, buf](std::int64_t res, bool) {
+            if (res != static_cast<std::int64_t>(block_size)) {
+                failed.fetch_add(1U, std::memory_order_relaxed);
+            }
+
+            issue(buf);
+            done.count_down();
+        });
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t slot = 0; slot < slots; ++slot) {
+        issue(buffers.data() + slot * block_size);
+    }
+
+    done.wait();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double mib = static_cast<double>(reads * block_size) / (1024.0 * 1024.0);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    std::printf(
+        "%-8s %10.0f reads/s %10.1f MiB/s%s\n", ops.uses_io_uring() ? "io_uring" : "pool",
+        static_cast<double>(reads) / elapsed.count(), mib / elapsed.count(),
+        failed.load() != 0 ? " (some reads failed)" : ""
+    );
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t size    = arg(argc, argv, 1, 64) << 20U;
+    const std::size_t reads   = arg(argc, argv, 2, 100000);
+    const std::size_t threads = arg(argc, argv, 3, 0);
+
+    const char* tmpdir = std::getenv("TMPDIR");  // NOLINT(concurrency-mt-unsafe)
+    const auto path    = std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/bench_file_ops.dat";
+    if (size < block_size || !create_file(path, size)) {
+        std::fprintf(stderr, "Failed to create %s\n", path.c_str());  // NOLINT(cppcoreguidelines-pro-type-vararg)
+        return EXIT_FAILURE;
+    }
+
+    const int fd = open(path.c_str(), O_RDONLY);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (fd >= 0) {
+        wwa::thread_pool pool(threads);
+        run(pool, {.queue_depth = 256, .use_io_uring = true}, fd, size, reads);
+        run(pool, {.queue_depth = 256, .use_io_uring = false}, fd, size, reads);
+        close(fd);
+    }
+
+    unlink(path.c_str());
+    return fd >= 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
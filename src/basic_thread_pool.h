@@ -0,0 +1,270 @@
+#ifndef B91E6F3A_4C2D_4D87_A5E0_6D1F8B2C7A94
+#define B91E6F3A_4C2D_4D87_A5E0_6D1F8B2C7A94
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wwa {
+
+// Queue policies: plain containers, always accessed under the pool's mutex
+
+template<typename Task>
+class fifo_queue {
+public:
+    void push(Task&& task) { this->m_queue.push_back(std::move(task)); }
+
+    Task pop()
+    {
+        Task task = std::move(this->m_queue.front());
+        this->m_queue.pop_front();
+        return task;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return this->m_queue.empty(); }
+    [[nodiscard]] std::size_t size() const noexcept { return this->m_queue.size(); }
+
+private:
+    std::deque<Task> m_queue;
+};
+
+template<typename Task>
+class lifo_queue {
+public:
+    void push(Task&& task) { this->m_queue.push_back(std::move(task)); }
+
+    Task pop()
+    {
+        Task task = std::move(this->m_queue.back());
+        this->m_queue.pop_back();
+        return task;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return this->m_queue.empty(); }
+    [[nodiscard]] std::size_t size() const noexcept { return this->m_queue.size(); }
+
+private:
+    std::vector<Task> m_queue;
+};
+
+// Idle policies: how a worker waits for work; `wait()` is called with the pool's mutex held
+
+class blocking_idle {
+public:
+    template<typename Lock, typename Predicate>
+    void wait(Lock& lock, const std::stop_token& token, Predicate pred)
+    {
+        this->m_cv.wait(lock, token, pred);
+    }
+
+    void notify_one() { this->m_cv.notify_one(); }
+
+private:
+    std::condition_variable_any m_cv;
+};
+
+// Spins for a while before going to sleep; `notify_one()` only makes a system call if a worker is asleep
+template<unsigned int Spins = 64>
+class spinning_idle {
+public:
+    template<typename Lock, typename Predicate>
+    void wait(Lock& lock, const std::stop_token& token, Predicate pred)
+    {
+        for (unsigned int i = 0; i < Spins && !pred() && !token.stop_requested(); ++i) {
+            const auto epoch = this->m_epoch.load(std::memory_order_acquire);
+            lock.unlock();
+            for (unsigned int j = 0; j < Spins && this->m_epoch.load(std::memory_order_relaxed) == epoch; ++j) {
+                std::this_thread::yield();
+            }
+
+            lock.lock();
+        }
+
+        if (!pred()) {
+            this->m_sleepers.fetch_add(1U, std::memory_order_relaxed);
+            this->m_cv.wait(lock, token, pred);
+            this->m_sleepers.fetch_sub(1U, std::memory_order_relaxed);
+        }
+    }
+
+    void notify_one()
+    {
+        this->m_epoch.fetch_add(1U, std::memory_order_release);
+        if (this->m_sleepers.load(std::memory_order_relaxed) != 0) {
+            this->m_cv.notify_one();
+        }
+    }
+
+private:
+    std::condition_variable_any m_cv;
+    std::atomic<unsigned int> m_epoch{0};
+    std::atomic<unsigned int> m_sleepers{0};
+};
+
+// Stats policies
+
+struct no_stats {
+    void task_submitted() noexcept {}
+    void task_started() noexcept {}
+    void task_finished(bool) noexcept {}
+};
+
+class basic_stats {
+public:
+    void task_submitted() noexcept { this->m_tasks_queued.fetch_add(1U, std::memory_order_relaxed); }
+
+    void task_started() noexcept
+    {
+        auto n = this->m_active_threads.fetch_add(1U, std::memory_order_relaxed) + 1U;
+        auto m = this->m_max_active_threads.load(std::memory_order_relaxed);
+        while (m < n && !this->m_max_active_threads.compare_exchange_weak(m, n, std::memory_order_relaxed)) {
+            // Do nothing
+        }
+    }
+
+    void task_finished(bool failed) noexcept
+    {
+        this->m_active_threads.fetch_sub(1U, std::memory_order_relaxed);
+        (failed ? this->m_tasks_failed : this->m_tasks_completed).fetch_add(1U, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::size_t active_threads() const noexcept { return this->m_active_threads; }
+    [[nodiscard]] std::size_t max_active_threads() const noexcept { return this->m_max_active_threads; }
+    [[nodiscard]] std::size_t tasks_queued() const noexcept { return this->m_tasks_queued; }
+    [[nodiscard]] std::size_t tasks_completed() const noexcept { return this->m_tasks_completed; }
+    [[nodiscard]] std::size_t tasks_failed() const noexcept { return this->m_tasks_failed; }
+
+private:
+    std::atomic<std::size_t> m_active_threads{0};
+    std::atomic<std::size_t> m_max_active_threads{0};
+    std::atomic<std::size_t> m_tasks_queued{0};
+    std::atomic<std::size_t> m_tasks_completed{0};
+    std::atomic<std::size_t> m_tasks_failed{0};
+};
+
+// Header-only pool whose features are picked at compile time. There is no per-task cancellation or `after_work`:
+// a task is any callable stored in `Task`; if it accepts a `std::stop_token`, it gets the worker's token,
+// which is stopped when the pool is destroyed. Tasks still queued at that point are discarded.
+template<
+    template<typename> class QueuePolicy = fifo_queue, typename IdlePolicy = blocking_idle,
+    typename StatsPolicy = no_stats, typename Task = std::function<void(const std::stop_token&)>>
+class basic_thread_pool {
+public:
+    using task_type  = Task;
+    using queue_type = QueuePolicy<Task>;
+    using idle_type  = IdlePolicy;
+    using stats_type = StatsPolicy;
+
+    explicit basic_thread_pool(std::size_t n = 0)
+    {
+        const auto num_threads = (n == 0) ? std::thread::hardware_concurrency() : n;
+        this->m_threads.reserve(num_threads);
+        for (std::size_t i = 0; i < num_threads; ++i) {
+            this->m_threads.emplace_back([this](const std::stop_token& token) { this->worker_thread(token); });
+        }
+    }
+
+    ~basic_thread_pool()
+    {
+        for (auto& thread : this->m_threads) {
+            thread.request_stop();
+        }
+
+        this->m_threads.clear();
+    }
+
+    basic_thread_pool(const basic_thread_pool&)            = delete;
+    basic_thread_pool& operator=(const basic_thread_pool&) = delete;
+    basic_thread_pool(basic_thread_pool&&)                 = delete;
+    basic_thread_pool& operator=(basic_thread_pool&&)      = delete;
+
+    template<typename F>
+    void submit(F&& task)
+    {
+        this->m_outstanding.fetch_add(1U, std::memory_order_relaxed);
+        {
+            const std::scoped_lock<std::mutex> lock(this->m_mutex);
+            this->m_queue.push(Task(std::forward<F>(task)));
+        }
+
+        this->m_stats.task_submitted();
+        this->m_idle.notify_one();
+    }
+
+    void wait() const
+    {
+        auto n = this->m_outstanding.load(std::memory_order_acquire);
+        while (n != 0) {
+            this->m_outstanding.wait(n, std::memory_order_acquire);
+            n = this->m_outstanding.load(std::memory_order_acquire);
+        }
+    }
+
+    [[nodiscard]] std::size_t num_threads() const noexcept { return this->m_threads.size(); }
+
+    [[nodiscard]] std::size_t work_queue_size() const
+    {
+        const std::scoped_lock<std::mutex> lock(this->m_mutex);
+        return this->m_queue.size();
+    }
+
+    [[nodiscard]] const StatsPolicy& stats() const noexcept { return this->m_stats; }
+
+private:
+    QueuePolicy<Task> m_queue;
+    [[no_unique_address]] IdlePolicy m_idle;
+    [[no_unique_address]] StatsPolicy m_stats;
+    mutable std::mutex m_mutex;
+    std::atomic<std::size_t> m_outstanding{0};
+    std::vector<std::jthread> m_threads;
+
+    void worker_thread(const std::stop_token& token)
+    {
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        while (true) {
+            this->m_idle.wait(lock, token, [this] { return !this->m_queue.empty(); });
+            if (token.stop_requested()) {
+                return;
+            }
+
+            this->run(this->m_queue.pop(), lock, token);
+            lock.lock();
+        }
+    }
+
+    void run(Task task, std::unique_lock<std::mutex>& lock, const std::stop_token& token)
+    {
+        lock.unlock();
+        this->m_stats.task_started();
+
+        bool failed = false;
+        try {
+            if constexpr (std::is_invocable_v<Task&, const std::stop_token&>) {
+                task(token);
+            }
+            else {
+                task();
+            }
+        }
+        catch (...) {
+            failed = true;
+        }
+
+        this->m_stats.task_finished(failed);
+        if (this->m_outstanding.fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+            this->m_outstanding.notify_all();
+        }
+    }
+};
+
+}  // namespace wwa
+
+#endif /* B91E6F3A_4C2D_4D87_A5E0_6D1F8B2C7A94 */
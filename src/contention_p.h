@@ -0,0 +1,76 @@
+#ifndef B4B1E37F_D503_4C37_9A96_0356594F9E78
+#define B4B1E37F_D503_4C37_9A96_0356594F9E78
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace wwa {
+
+// `std::mutex` that measures how long threads wait for it and how long they hold it
+class profiled_mutex {
+public:
+    void lock()
+    {
+        if (!this->m_mutex.try_lock()) {
+            const auto start = profiled_mutex::now();
+            this->m_mutex.lock();
+            this->m_wait_ns.fetch_add(profiled_mutex::now() - start, std::memory_order_relaxed);
+            this->m_contended.fetch_add(1U, std::memory_order_relaxed);
+        }
+
+        this->locked();
+    }
+
+    bool try_lock()
+    {
+        if (this->m_mutex.try_lock()) {
+            this->locked();
+            return true;
+        }
+
+        return false;
+    }
+
+    void unlock()
+    {
+        this->m_hold_ns.fetch_add(profiled_mutex::now() - this->m_locked_at, std::memory_order_relaxed);
+        this->m_mutex.unlock();
+    }
+
+    [[nodiscard]] std::uint64_t acquisitions() const noexcept { return this->m_acquisitions; }
+    [[nodiscard]] std::uint64_t contended() const noexcept { return this->m_contended; }
+    [[nodiscard]] std::int64_t wait_ns() const noexcept { return this->m_wait_ns; }
+    [[nodiscard]] std::int64_t hold_ns() const noexcept { return this->m_hold_ns; }
+
+private:
+    std::mutex m_mutex;
+    std::int64_t m_locked_at = 0;  // only accessed by the owner
+    std::atomic<std::uint64_t> m_acquisitions{0};
+    std::atomic<std::uint64_t> m_contended{0};
+    std::atomic<std::int64_t> m_wait_ns{0};
+    std::atomic<std::int64_t> m_hold_ns{0};
+
+    void locked() noexcept
+    {
+        this->m_locked_at = profiled_mutex::now();
+        this->m_acquisitions.fetch_add(1U, std::memory_order_relaxed);
+    }
+
+    static std::int64_t now() noexcept
+    {
+        const auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    }
+};
+
+struct contention_counters {
+    std::atomic<std::uint64_t> wakeups{0};
+    std::atomic<std::uint64_t> spurious_wakeups{0};
+    std::atomic<std::uint64_t> notifications{0};
+};
+
+}  // namespace wwa
+
+#endif /* B4B1E37F_D503_4C37_9A96_0356594F9E78 */
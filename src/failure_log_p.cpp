@@ -0,0 +1,41 @@
+#include "failure_log_p.h"
+
+#include <chrono>
+
+namespace wwa {
+
+void failure_log::record(const std::exception_ptr& exception) noexcept
+{
+    const auto idx = this->m_head.fetch_add(1U, std::memory_order_relaxed);
+    auto& slot     = this->m_slots[idx % failure_log::capacity];
+
+    if (!slot.busy.test_and_set(std::memory_order_acquire)) {
+        slot.seq              = idx + 1U;
+        slot.record.timestamp = std::chrono::steady_clock::now();
+        slot.record.exception = exception;
+        slot.busy.clear(std::memory_order_release);
+    }
+}
+
+std::vector<thread_pool::failure_record> failure_log::snapshot() const
+{
+    const auto head  = this->m_head.load(std::memory_order_relaxed);
+    const auto first = head > failure_log::capacity ? head - failure_log::capacity : 0;
+
+    std::vector<thread_pool::failure_record> result;
+    result.reserve(head - first);
+    for (auto idx = first; idx < head; ++idx) {
+        const auto& slot = this->m_slots[idx % failure_log::capacity];
+        if (!slot.busy.test_and_set(std::memory_order_acquire)) {
+            if (slot.seq == idx + 1U) {
+                result.push_back(slot.record);
+            }
+
+            slot.busy.clear(std::memory_order_release);
+        }
+    }
+
+    return result;
+}
+
+}  // namespace wwa
@@ -0,0 +1,37 @@
+#ifndef E7B2D5C9_1A4F_4E38_96C0_3F8A2D6B7E15
+#define E7B2D5C9_1A4F_4E38_96C0_3F8A2D6B7E15
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+#include "threadpool.h"
+
+namespace wwa {
+
+// Bounded ring of the most recent task failures. Recording never blocks: if the reader happens to be
+// copying the slot that is about to be overwritten, the new record is dropped.
+class failure_log {
+public:
+    static constexpr std::size_t capacity = 64;
+
+    void record(const std::exception_ptr& exception) noexcept;
+    std::vector<thread_pool::failure_record> snapshot() const;
+
+private:
+    struct slot {
+        mutable std::atomic_flag busy;
+        std::uint64_t seq = 0;
+        thread_pool::failure_record record;
+    };
+
+    std::array<slot, capacity> m_slots{};
+    std::atomic<std::uint64_t> m_head{0};
+};
+
+}  // namespace wwa
+
+#endif /* E7B2D5C9_1A4F_4E38_96C0_3F8A2D6B7E15 */
@@ -0,0 +1,72 @@
+#include "file_ops.h"
+#include "file_ops_p.h"
+
+#include <memory>
+#include <stdexcept>
+
+namespace wwa {
+
+file_ops::file_ops(thread_pool& pool) : file_ops(pool, options{}) {}
+
+file_ops::file_ops(thread_pool& pool, const options& opts) : m_impl(std::make_unique<file_ops_private>(pool, opts)) {}
+
+file_ops::~file_ops() = default;
+
+void file_ops::open(
+    const char* path, int flags, unsigned int mode, const completion_t& done, const std::stop_token& token
+)
+{
+    if (path == nullptr || done == nullptr) {
+        throw std::invalid_argument("path and completion cannot be null");
+    }
+
+    this->m_impl->open(path, flags, mode, done, token);
+}
+
+void file_ops::read(
+    int fd, void* buf, std::size_t len, std::uint64_t offset, const completion_t& done, const std::stop_token& token
+)
+{
+    if (done == nullptr) {
+        throw std::invalid_argument("completion cannot be null");
+    }
+
+    this->m_impl->read(fd, buf, len, offset, done, token);
+}
+
+void file_ops::write(
+    int fd, const void* buf, std::size_t len, std::uint64_t offset, const completion_t& done,
+    const std::stop_token& token
+)
+{
+    if (done == nullptr) {
+        throw std::invalid_argument("completion cannot be null");
+    }
+
+    this->m_impl->write(fd, buf, len, offset, done, token);
+}
+
+void file_ops::fsync(int fd, bool datasync, const completion_t& done, const std::stop_token& token)
+{
+    if (done == nullptr) {
+        throw std::invalid_argument("completion cannot be null");
+    }
+
+    this->m_impl->fsync(fd, datasync, done, token);
+}
+
+void file_ops::stat(const char* path, struct ::stat* buf, const completion_t& done, const std::stop_token& token)
+{
+    if (path == nullptr || buf == nullptr || done == nullptr) {
+        throw std::invalid_argument("path, buffer and completion cannot be null");
+    }
+
+    this->m_impl->stat(path, buf, done, token);
+}
+
+bool file_ops::uses_io_uring() const noexcept
+{
+    return this->m_impl->uses_io_uring();
+}
+
+}  // namespace wwa
@@ -0,0 +1,70 @@
+#ifndef D1E4EDAF_DF73_439B_BD26_E6C134F824C6
+#define D1E4EDAF_DF73_439B_BD26_E6C134F824C6
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stop_token>
+
+#include "export.h"
+#include "threadpool.h"
+
+struct stat;
+
+namespace wwa {
+
+class file_ops_private;
+
+// Asynchronous file system calls. Where the kernel supports io_uring (Linux 5.6 and later), requests are handed
+// to the kernel directly and their completions are run on a single internal thread; otherwise, every call runs
+// as a blocking task on the pool. The completion gets the result of the system call (non-negative on success,
+// `-errno` on failure) and whether the request was canceled through its stop token. Completions should be short
+// and must not throw. Paths are copied; buffers must stay valid until the completion has run. If the kernel rejects
+// a request, or the ring stops reporting completions, the affected requests complete with that error.
+// A completion may destroy the `file_ops`; the destructor then waits for the other requests in flight, running
+// their completions on the same thread.
+class WWA_SIMPLE_THREADPOOL_EXPORT file_ops {
+public:
+    using completion_t = std::function<void(std::int64_t result, bool canceled)>;
+
+    struct options {
+        unsigned int queue_depth = 256;  // most io_uring requests in flight; `submit()` waits for a free slot
+        bool use_io_uring        = true;
+    };
+
+    explicit file_ops(thread_pool& pool);
+    file_ops(thread_pool& pool, const options& opts);
+    ~file_ops();
+
+    file_ops(const file_ops&)                = delete;
+    file_ops& operator=(const file_ops&)     = delete;
+    file_ops(file_ops&&) noexcept            = default;
+    file_ops& operator=(file_ops&&) noexcept = default;
+
+    void open(
+        const char* path, int flags, unsigned int mode, const completion_t& done, const std::stop_token& token = {}
+    );
+
+    void read(
+        int fd, void* buf, std::size_t len, std::uint64_t offset, const completion_t& done,
+        const std::stop_token& token = {}
+    );
+
+    void write(
+        int fd, const void* buf, std::size_t len, std::uint64_t offset, const completion_t& done,
+        const std::stop_token& token = {}
+    );
+
+    void fsync(int fd, bool datasync, const completion_t& done, const std::stop_token& token = {});
+    void stat(const char* path, struct ::stat* buf, const completion_t& done, const std::stop_token& token = {});
+
+    [[nodiscard]] bool uses_io_uring() const noexcept;
+
+private:
+    std::unique_ptr<file_ops_private> m_impl;
+};
+
+}  // namespace wwa
+
+#endif /* D1E4EDAF_DF73_439B_BD26_E6C134F824C6 */
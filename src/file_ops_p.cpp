@@ -0,0 +1,599 @@
+#include "file_ops_p.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <utility>
+
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_IO_URING
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <sys/sysmacros.h>
+
+#    include <algorithm>
+#    include <atomic>
+#    include <cstddef>
+#    include <initializer_list>
+#    include <limits>
+#    include <thread>
+#    include <vector>
+#endif
+
+namespace {
+
+std::int64_t result_or_errno(std::int64_t result)
+{
+    return (result < 0) ? -errno : result;
+}
+
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_IO_URING
+int io_uring_setup(unsigned int entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned int opcode, void* arg, unsigned int nr_args)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+unsigned int load_acquire(unsigned int* p)
+{
+    return std::atomic_ref<unsigned int>(*p).load(std::memory_order_acquire);
+}
+
+void store_release(unsigned int* p, unsigned int value)
+{
+    std::atomic_ref<unsigned int>(*p).store(value, std::memory_order_release);
+}
+
+bool supports_required_ops(int fd)
+{
+    constexpr unsigned int max_ops = 256;
+
+    std::vector<std::byte> storage(sizeof(io_uring_probe) + max_ops * sizeof(io_uring_probe_op));
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());  // NOLINT(*-reinterpret-cast)
+    if (io_uring_register(fd, IORING_REGISTER_PROBE, probe, max_ops) < 0) {
+        return false;
+    }
+
+    return std::ranges::all_of(
+        std::initializer_list<unsigned int>{
+            IORING_OP_NOP, IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC, IORING_OP_STATX,
+            IORING_OP_ASYNC_CANCEL
+        },
+        [probe](unsigned int op) {
+            return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;  // NOLINT
+        }
+    );
+}
+
+void statx_to_stat(const struct statx& sx, struct ::stat& st)
+{
+    st            = {};
+    st.st_dev     = makedev(sx.stx_dev_major, sx.stx_dev_minor);
+    st.st_ino     = sx.stx_ino;
+    st.st_mode    = sx.stx_mode;
+    st.st_nlink   = sx.stx_nlink;
+    st.st_uid     = sx.stx_uid;
+    st.st_gid     = sx.stx_gid;
+    st.st_rdev    = makedev(sx.stx_rdev_major, sx.stx_rdev_minor);
+    st.st_size    = static_cast<off_t>(sx.stx_size);
+    st.st_blksize = static_cast<blksize_t>(sx.stx_blksize);
+    st.st_blocks  = static_cast<blkcnt_t>(sx.stx_blocks);
+    st.st_atim    = {.tv_sec = sx.stx_atime.tv_sec, .tv_nsec = sx.stx_atime.tv_nsec};
+    st.st_mtim    = {.tv_sec = sx.stx_mtime.tv_sec, .tv_nsec = sx.stx_mtime.tv_nsec};
+    st.st_ctim    = {.tv_sec = sx.stx_ctime.tv_sec, .tv_nsec = sx.stx_ctime.tv_nsec};
+}
+#endif
+
+}  // namespace
+
+namespace wwa {
+
+file_ops_private::file_ops_private(thread_pool& pool, [[maybe_unused]] const file_ops::options& opts) : m_pool(pool)
+{
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_IO_URING
+    if (opts.use_io_uring && this->setup_ring(std::max(opts.queue_depth, 1U))) {
+        this->m_reaper = std::jthread([this] { this->reap(); });
+    }
+#endif
+}
+
+file_ops_private::~file_ops_private()
+{
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_IO_URING
+    if (std::this_thread::get_id() == this->m_reaper.get_id()) {
+        // Destroyed from a completion: nobody else can reap the requests still in flight, so do it here.
+        // `reap()` returns as soon as the completion does, without touching the object again
+        *this->m_destroyed = true;
+        this->m_reaper.detach();
+        while (true) {
+            {
+                const std::scoped_lock<std::mutex> lock(this->m_mutex);
+                if (this->m_requests.empty()) {
+                    break;
+                }
+            }
+
+            if (!this->reap_one()) {
+                break;
+            }
+        }
+    }
+    else if (this->m_reaper.joinable()) {
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        this->m_slots_cv.wait(lock, [this] { return this->m_requests.empty(); });
+
+        io_uring_sqe sqe{};
+        sqe.opcode    = IORING_OP_NOP;
+        sqe.user_data = stop_tag;
+        while (this->m_ring_error == 0 && this->push(sqe) < 0) {
+            // The completion thread exits on its own if the ring is broken
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+
+        lock.unlock();
+        this->m_reaper.join();
+    }
+
+    this->close_ring();
+#endif
+}
+
+void file_ops_private::open(
+    const char* path, int flags, unsigned int mode, const file_ops::completion_t& done, const std::stop_token& token
+)
+{
+    auto req   = std::make_shared<request>();
+    req->kind  = op::open;
+    req->path  = path;
+    req->flags = flags;
+    req->mode  = mode;
+    req->done  = done;
+    this->submit(std::move(req), token);
+}
+
+void file_ops_private::read(
+    int fd, void* buf, std::size_t len, std::uint64_t offset, const file_ops::completion_t& done,
+    const std::stop_token& token
+)
+{
+    auto req    = std::make_shared<request>();
+    req->kind   = op::read;
+    req->fd     = fd;
+    req->buf    = buf;
+    req->len    = len;
+    req->offset = offset;
+    req->done   = done;
+    this->submit(std::move(req), token);
+}
+
+void file_ops_private::write(
+    int fd, const void* buf, std::size_t len, std::uint64_t offset, const file_ops::completion_t& done,
+    const std::stop_token& token
+)
+{
+    auto req    = std::make_shared<request>();
+    req->kind   = op::write;
+    req->fd     = fd;
+    req->buf    = const_cast<void*>(buf);  // NOLINT(*-const-cast)
+    req->len    = len;
+    req->offset = offset;
+    req->done   = done;
+    this->submit(std::move(req), token);
+}
+
+void file_ops_private::fsync(int fd, bool datasync, const file_ops::completion_t& done, const std::stop_token& token)
+{
+    auto req  = std::make_shared<request>();
+    req->kind = datasync ? op::fdatasync : op::fsync;
+    req->fd   = fd;
+    req->done = done;
+    this->submit(std::move(req), token);
+}
+
+void file_ops_private::stat(
+    const char* path, struct ::stat* buf, const file_ops::completion_t& done, const std::stop_token& token
+)
+{
+    auto req      = std::make_shared<request>();
+    req->kind     = op::stat;
+    req->path     = path;
+    req->stat_buf = buf;
+    req->done     = done;
+    this->submit(std::move(req), token);
+}
+
+bool file_ops_private::uses_io_uring() const noexcept
+{
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_IO_URING
+    return this->m_reaper.joinable();
+#else
+    return false;
+#endif
+}
+
+std::int64_t file_ops_private::request::perform() const
+{
+    std::int64_t result = 0;
+    do {
+        switch (this->kind) {
+            case op::open:
+                result = ::open(this->path.c_str(), this->flags, this->mode);  // NOLINT(*-vararg)
+                break;
+            case op::read:
+                result = ::pread(this->fd, this->buf, this->len, static_cast<off_t>(this->offset));
+                break;
+            case op::write:
+                result = ::pwrite(this->fd, this->buf, this->len, static_cast<off_t>(this->offset));
+                break;
+            case op::fsync:
+                result = ::fsync(this->fd);
+                break;
+            case op::fdatasync:
+#ifdef __linux__
+                result = ::fdatasync(this->fd);
+#else
+                result = ::fsync(this->fd);
+#endif
+                break;
+            case op::stat:
+                result = ::stat(this->path.c_str(), this->stat_buf);
+                break;
+        }
+    } while (result < 0 && errno == EINTR);
+
+    return result_or_errno(result);
+}
+
+void file_ops_private::submit(std::shared_ptr<request> req, const std::stop_token& token)
+{
+    if (token.stop_requested()) {
+        req->done(-ECANCELED, true);
+        return;
+    }
+
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_IO_URING
+    if (this->uses_io_uring()) {
+        this->submit_to_ring(std::move(req), token);
+        return;
+    }
+#endif
+
+    this->submit_to_pool(req, token);
+}
+
+void file_ops_private::submit_to_pool(const std::shared_ptr<request>& req, const std::stop_token& token)
+{
+    this->m_pool.submit(
+        [req, token](const std::stop_token& pool_token) {
+            if (!token.stop_requested() && !pool_token.stop_requested()) {
+                req->result    = req->perform();
+                req->performed = true;
+            }
+        },
+        [req](bool canceled) {
+            // A system call that fails with `ECANCELED` has still run; only a skipped one counts as canceled
+            canceled = canceled || !req->performed;
+            req->done(canceled ? -ECANCELED : req->result, canceled);
+        }
+    );
+}
+
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_IO_URING
+bool file_ops_private::setup_ring(unsigned int entries)
+{
+    io_uring_params params{};
+    this->m_ring_fd = io_uring_setup(entries, &params);
+    if (this->m_ring_fd < 0) {
+        return false;
+    }
+
+    // The opcode probe needs Linux 5.6; the features below are older than that
+    constexpr auto required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP;
+    if ((params.features & required) != required || !supports_required_ops(this->m_ring_fd)) {
+        this->close_ring();
+        return false;
+    }
+
+    this->m_ring_size = std::max(
+        params.sq_off.array + params.sq_entries * sizeof(unsigned int),
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe)
+    );
+
+    auto* ring = mmap(
+        nullptr, this->m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->m_ring_fd,
+        IORING_OFF_SQ_RING
+    );
+
+    if (ring == MAP_FAILED) {
+        this->close_ring();
+        return false;
+    }
+
+    this->m_ring      = ring;
+    this->m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    auto* sqes        = mmap(
+        nullptr, this->m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->m_ring_fd, IORING_OFF_SQES
+    );
+
+    if (sqes == MAP_FAILED) {
+        this->close_ring();
+        return false;
+    }
+
+    // NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+    auto* base          = static_cast<char*>(ring);
+    this->m_sqes        = static_cast<io_uring_sqe*>(sqes);
+    this->m_sq_head     = reinterpret_cast<unsigned int*>(base + params.sq_off.head);
+    this->m_sq_tail     = reinterpret_cast<unsigned int*>(base + params.sq_off.tail);
+    this->m_sq_array    = reinterpret_cast<unsigned int*>(base + params.sq_off.array);
+    this->m_sq_mask     = *reinterpret_cast<unsigned int*>(base + params.sq_off.ring_mask);
+    this->m_cq_head     = reinterpret_cast<unsigned int*>(base + params.cq_off.head);
+    this->m_cq_tail     = reinterpret_cast<unsigned int*>(base + params.cq_off.tail);
+    this->m_cqes        = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+    this->m_cq_mask     = *reinterpret_cast<unsigned int*>(base + params.cq_off.ring_mask);
+    // NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+
+    // Each request may be followed by a cancellation; the completion ring has room for both
+    this->m_sq_entries  = params.sq_entries;
+    this->m_max_pending = std::min(params.sq_entries, params.cq_entries / 2);
+    return true;
+}
+
+void file_ops_private::close_ring() noexcept
+{
+    if (this->m_sqes != nullptr) {
+        munmap(this->m_sqes, this->m_sqes_size);
+        this->m_sqes = nullptr;
+    }
+
+    if (this->m_ring != nullptr) {
+        munmap(this->m_ring, this->m_ring_size);
+        this->m_ring = nullptr;
+    }
+
+    if (this->m_ring_fd >= 0) {
+        ::close(this->m_ring_fd);
+        this->m_ring_fd = -1;
+    }
+}
+
+void file_ops_private::submit_to_ring(std::shared_ptr<request> req, const std::stop_token& token)
+{
+    // Completions may submit follow-up requests; the completion thread must not wait for itself to free a slot
+    const bool on_reaper = std::this_thread::get_id() == this->m_reaper.get_id();
+
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    this->m_slots_cv.wait(lock, [this, on_reaper] {
+        return on_reaper || this->m_ring_error != 0 || this->m_requests.size() < this->m_max_pending;
+    });
+
+    if (this->m_ring_error != 0) {
+        const auto error = this->m_ring_error;
+        lock.unlock();
+        req->done(-error, false);
+        return;
+    }
+
+    const auto id = ++this->m_next_id;
+    auto* rr      = this->m_requests.emplace(id, std::make_unique<ring_request>()).first->second.get();
+    rr->req       = std::move(req);
+    lock.unlock();
+
+    // The request cannot complete before it is submitted, so `rr` stays valid until then.
+    // If the token gets stopped while the callback is being registered, the callback runs right here
+    if (token.stop_possible()) {
+        rr->on_stop.emplace(token, canceler{this, id});
+    }
+
+    lock.lock();
+    int error = -ECANCELED;
+    if (!rr->stop_requested) {
+        io_uring_sqe sqe{};
+        this->prepare(sqe, *rr);
+        sqe.user_data = id;
+        error         = this->push(sqe);
+        if (error == 0) {
+            rr->submitted = true;
+            return;
+        }
+    }
+
+    auto node = this->m_requests.extract(id);
+    this->m_slots_cv.notify_all();
+    lock.unlock();
+
+    const auto failed = std::move(node.mapped()->req);
+    node              = {};
+    failed->done(error, error == -ECANCELED);
+}
+
+int file_ops_private::push(const io_uring_sqe& sqe)
+{
+    // Called with `m_mutex` held. Entries are submitted one at a time, so the kernel has consumed all earlier ones
+    const auto tail = *this->m_sq_tail;
+    if (tail - load_acquire(this->m_sq_head) >= this->m_sq_entries) {
+        return -EBUSY;
+    }
+
+    const auto index        = tail & this->m_sq_mask;
+    this->m_sqes[index]     = sqe;    // NOLINT(*-pointer-arithmetic)
+    this->m_sq_array[index] = index;  // NOLINT(*-pointer-arithmetic)
+    store_release(this->m_sq_tail, tail + 1U);
+
+    int res = 0;
+    do {
+        res = io_uring_enter(this->m_ring_fd, 1, 0, 0);
+    } while (res < 0 && errno == EINTR);
+
+    if (res > 0 || load_acquire(this->m_sq_head) != tail) {
+        return 0;
+    }
+
+    // The kernel did not take the entry: take it back, so that it cannot be submitted along with a later one
+    const int error = (res < 0) ? errno : EAGAIN;
+    store_release(this->m_sq_tail, tail);
+    return -error;
+}
+
+void file_ops_private::prepare(io_uring_sqe& sqe, ring_request& rr) const
+{
+    constexpr std::size_t max_len = std::numeric_limits<std::uint32_t>::max();
+
+    const auto& req = *rr.req;
+    switch (req.kind) {
+        case op::open:
+            sqe.opcode     = IORING_OP_OPENAT;
+            sqe.fd         = AT_FDCWD;
+            sqe.addr       = reinterpret_cast<std::uintptr_t>(req.path.c_str());  // NOLINT(*-reinterpret-cast)
+            sqe.len        = req.mode;
+            sqe.open_flags = static_cast<std::uint32_t>(req.flags);
+            break;
+        case op::read:
+        case op::write:
+            // Lengths are 32-bit; a longer request completes as a short read or write
+            sqe.opcode = (req.kind == op::read) ? IORING_OP_READ : IORING_OP_WRITE;
+            sqe.fd     = req.fd;
+            sqe.addr   = reinterpret_cast<std::uintptr_t>(req.buf);  // NOLINT(*-reinterpret-cast)
+            sqe.len    = static_cast<std::uint32_t>(std::min<std::size_t>(req.len, max_len));
+            sqe.off    = req.offset;
+            break;
+        case op::fsync:
+        case op::fdatasync:
+            sqe.opcode      = IORING_OP_FSYNC;
+            sqe.fd          = req.fd;
+            sqe.fsync_flags = (req.kind == op::fdatasync) ? IORING_FSYNC_DATASYNC : 0U;
+            break;
+        case op::stat:
+            sqe.opcode = IORING_OP_STATX;
+            sqe.fd     = AT_FDCWD;
+            sqe.addr   = reinterpret_cast<std::uintptr_t>(req.path.c_str());  // NOLINT(*-reinterpret-cast)
+            sqe.len    = STATX_BASIC_STATS;
+            sqe.addr2  = reinterpret_cast<std::uintptr_t>(&rr.statx_buf);  // NOLINT(*-reinterpret-cast)
+            break;
+    }
+}
+
+void file_ops_private::reap()
+{
+    // A completion may destroy the object; the destructor then sets the flag and takes over
+    bool destroyed    = false;
+    this->m_destroyed = &destroyed;
+    while (this->reap_one() && !destroyed) {
+        // Keep going
+    }
+}
+
+bool file_ops_private::reap_one()
+{
+    const auto head = *this->m_cq_head;
+    if (head == load_acquire(this->m_cq_tail)) {
+        if (io_uring_enter(this->m_ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0) {
+            if (errno == EAGAIN || errno == EBUSY) {
+                std::this_thread::yield();
+            }
+            else if (errno != EINTR) {
+                this->fail_all(errno);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const auto& cqe      = this->m_cqes[head & this->m_cq_mask];  // NOLINT(*-pointer-arithmetic)
+    const auto user_data = cqe.user_data;
+    const auto result    = static_cast<std::int64_t>(cqe.res);
+    store_release(this->m_cq_head, head + 1U);
+
+    if (user_data == stop_tag) {
+        return false;
+    }
+
+    if (user_data != cancel_tag) {
+        this->complete(user_data, result);
+    }
+
+    return true;
+}
+
+void file_ops_private::complete(std::uint64_t id, std::int64_t result)
+{
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    auto node = this->m_requests.extract(id);
+    if (node.empty()) {
+        return;
+    }
+
+    const bool stop_requested = node.mapped()->stop_requested;
+    this->m_slots_cv.notify_all();
+    lock.unlock();
+
+    const bool canceled = stop_requested && (result == -ECANCELED || result == -EINTR);
+    auto& rr            = *node.mapped();
+    if (rr.req->kind == op::stat && result == 0) {
+        statx_to_stat(rr.statx_buf, *rr.req->stat_buf);
+    }
+
+    // Unregister the stop callback while the object is still alive: the completion may destroy it
+    auto req = std::move(rr.req);
+    node     = {};
+    req->done(result, canceled);
+}
+
+void file_ops_private::fail_all(int error)
+{
+    // The ring can no longer report completions. Requests still in flight may yet be carried out by the kernel,
+    // but there is no way to learn about it
+    decltype(this->m_requests) requests;
+    {
+        const std::scoped_lock<std::mutex> lock(this->m_mutex);
+        this->m_ring_error = error;
+        requests.swap(this->m_requests);
+        this->m_slots_cv.notify_all();
+    }
+
+    std::vector<std::shared_ptr<request>> failed;
+    failed.reserve(requests.size());
+    for (auto& [id, rr] : requests) {
+        failed.push_back(std::move(rr->req));
+    }
+
+    requests.clear();
+    for (const auto& req : failed) {
+        req->done(-error, false);
+    }
+}
+
+void file_ops_private::canceler::operator()() const
+{
+    const std::scoped_lock<std::mutex> lock(this->self->m_mutex);
+    auto it = this->self->m_requests.find(this->id);
+    if (it == this->self->m_requests.end()) {
+        return;
+    }
+
+    it->second->stop_requested = true;
+    if (it->second->submitted) {
+        // If the cancellation cannot be submitted, the request simply runs to completion
+        io_uring_sqe sqe{};
+        sqe.opcode    = IORING_OP_ASYNC_CANCEL;
+        sqe.addr      = this->id;
+        sqe.user_data = cancel_tag;
+        static_cast<void>(this->self->push(sqe));
+    }
+}
+#endif
+
+}  // namespace wwa
@@ -0,0 +1,141 @@
+#ifndef A369B20A_D87A_4B75_B24B_8FF9B7BFE1FC
+#define A369B20A_D87A_4B75_B24B_8FF9B7BFE1FC
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "file_ops.h"
+#include "threadpool.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#    define WWA_SIMPLE_THREADPOOL_HAVE_IO_URING
+#    include <linux/io_uring.h>
+#    include <sys/stat.h>
+#endif
+
+namespace wwa {
+
+class file_ops_private {
+public:
+    file_ops_private(thread_pool& pool, const file_ops::options& opts);
+    ~file_ops_private();
+
+    file_ops_private(const file_ops_private&)                = delete;
+    file_ops_private& operator=(const file_ops_private&)     = delete;
+    file_ops_private(file_ops_private&&) noexcept            = delete;
+    file_ops_private& operator=(file_ops_private&&) noexcept = delete;
+
+    void open(
+        const char* path, int flags, unsigned int mode, const file_ops::completion_t& done,
+        const std::stop_token& token
+    );
+
+    void read(
+        int fd, void* buf, std::size_t len, std::uint64_t offset, const file_ops::completion_t& done,
+        const std::stop_token& token
+    );
+
+    void write(
+        int fd, const void* buf, std::size_t len, std::uint64_t offset, const file_ops::completion_t& done,
+        const std::stop_token& token
+    );
+
+    void fsync(int fd, bool datasync, const file_ops::completion_t& done, const std::stop_token& token);
+    void stat(const char* path, struct ::stat* buf, const file_ops::completion_t& done, const std::stop_token& token);
+
+    bool uses_io_uring() const noexcept;
+
+private:
+    enum class op : std::uint8_t { open, read, write, fsync, fdatasync, stat };
+
+    struct request {
+        // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+        op kind;
+        int fd               = -1;
+        int flags            = 0;
+        unsigned int mode    = 0;
+        void* buf            = nullptr;
+        std::size_t len      = 0;
+        std::uint64_t offset = 0;
+        std::string path;
+        struct ::stat* stat_buf = nullptr;
+        file_ops::completion_t done;
+        std::int64_t result = 0;
+        bool performed      = false;
+        // NOLINTEND(misc-non-private-member-variables-in-classes)
+
+        std::int64_t perform() const;
+    };
+
+    thread_pool& m_pool;
+
+    void submit(std::shared_ptr<request> req, const std::stop_token& token);
+    void submit_to_pool(const std::shared_ptr<request>& req, const std::stop_token& token);
+
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_IO_URING
+    struct canceler {
+        file_ops_private* self;
+        std::uint64_t id;
+
+        void operator()() const;
+    };
+
+    struct ring_request {
+        std::shared_ptr<request> req;
+        struct statx statx_buf {};
+        bool submitted      = false;
+        bool stop_requested = false;
+        std::optional<std::stop_callback<canceler>> on_stop;
+    };
+
+    // `user_data` values that do not belong to a request
+    static constexpr std::uint64_t cancel_tag = ~std::uint64_t{0};
+    static constexpr std::uint64_t stop_tag   = ~std::uint64_t{0} - 1U;
+
+    int m_ring_fd              = -1;
+    void* m_ring               = nullptr;
+    std::size_t m_ring_size    = 0;
+    io_uring_sqe* m_sqes       = nullptr;
+    std::size_t m_sqes_size    = 0;
+    unsigned int* m_sq_head    = nullptr;
+    unsigned int* m_sq_tail    = nullptr;
+    unsigned int* m_sq_array   = nullptr;
+    unsigned int m_sq_mask     = 0;
+    unsigned int* m_cq_head    = nullptr;
+    unsigned int* m_cq_tail    = nullptr;
+    io_uring_cqe* m_cqes       = nullptr;
+    unsigned int m_cq_mask     = 0;
+    unsigned int m_sq_entries  = 0;
+    unsigned int m_max_pending = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_slots_cv;
+    std::unordered_map<std::uint64_t, std::unique_ptr<ring_request>> m_requests;
+    std::uint64_t m_next_id = 0;
+    int m_ring_error        = 0;  // set once the completion thread could no longer wait for completions
+    bool* m_destroyed       = nullptr;
+    std::jthread m_reaper;
+
+    bool setup_ring(unsigned int entries);
+    void close_ring() noexcept;
+    void submit_to_ring(std::shared_ptr<request> req, const std::stop_token& token);
+    int push(const io_uring_sqe& sqe);
+    void prepare(io_uring_sqe& sqe, ring_request& rr) const;
+    void reap();
+    bool reap_one();
+    void complete(std::uint64_t id, std::int64_t result);
+    void fail_all(int error);
+#endif
+};
+
+}  // namespace wwa
+
+#endif /* A369B20A_D87A_4B75_B24B_8FF9B7BFE1FC */
@@ -0,0 +1,155 @@
+#include "handle_table_p.h"
+#include "threadpool_p.h"
+
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+class spin_lock {
+public:
+    explicit spin_lock(std::atomic_flag& flag) noexcept : m_flag(flag)
+    {
+        while (this->m_flag.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    ~spin_lock() { this->m_flag.clear(std::memory_order_release); }
+
+    spin_lock(const spin_lock&)            = delete;
+    spin_lock& operator=(const spin_lock&) = delete;
+    spin_lock(spin_lock&&)                 = delete;
+    spin_lock& operator=(spin_lock&&)      = delete;
+
+private:
+    std::atomic_flag& m_flag;
+};
+
+}  // namespace
+
+namespace wwa {
+
+using task_status = thread_pool::task_status;
+
+handle_table::~handle_table()
+{
+    for (auto& chunk : this->m_chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);  // NOLINT(cppcoreguidelines-owning-memory)
+    }
+}
+
+thread_pool::task_handle handle_table::acquire(work_item* item)
+{
+    std::uint32_t index = 0;
+
+    {
+        const std::scoped_lock<std::mutex> lock(this->m_mutex);
+        if (!this->m_free.empty()) {
+            index = this->m_free.front();
+            this->m_free.pop_front();
+        }
+        else {
+            index = this->m_size.load(std::memory_order_relaxed);
+            if (index == chunk_size * max_chunks) {
+                throw std::runtime_error("too many tasks in flight");
+            }
+
+            auto& chunk = this->m_chunks[index / chunk_size];
+            if (chunk.load(std::memory_order_relaxed) == nullptr) {
+                auto* slots = new slot[chunk_size];  // NOLINT(cppcoreguidelines-owning-memory)
+                chunk.store(slots, std::memory_order_release);
+            }
+
+            this->m_size.store(index + 1U, std::memory_order_release);
+        }
+    }
+
+    auto& s = *this->find(index);
+    const spin_lock lock(s.busy);
+    s.generation = (s.generation == ~std::uint32_t{0}) ? 1U : s.generation + 1U;
+    s.status     = task_status::queued;
+    s.item       = item;
+    return {index, s.generation};
+}
+
+bool handle_table::start(std::uint32_t index)
+{
+    auto& s = *this->find(index);
+
+    {
+        const spin_lock lock(s.busy);
+        if (s.status != task_status::canceled) {
+            s.status = task_status::running;
+            return true;
+        }
+
+        s.item = nullptr;
+    }
+
+    this->release(index);
+    return false;
+}
+
+void handle_table::finish(std::uint32_t index, task_status status)
+{
+    auto& s = *this->find(index);
+
+    {
+        const spin_lock lock(s.busy);
+        s.status = status;
+        s.item   = nullptr;
+    }
+
+    this->release(index);
+}
+
+bool handle_table::cancel(thread_pool::task_handle handle) noexcept
+{
+    auto* s = this->find(handle.index);
+    if (s == nullptr) {
+        return false;
+    }
+
+    const spin_lock lock(s->busy);
+    if (s->generation != handle.generation || s->item == nullptr) {
+        return false;
+    }
+
+    // The worker that dequeues a canceled task skips it; a running task only gets a stop request
+    s->item->stop();
+    if (s->status == task_status::queued) {
+        s->status = task_status::canceled;
+        return true;
+    }
+
+    return false;
+}
+
+task_status handle_table::status(thread_pool::task_handle handle) const noexcept
+{
+    const auto* s = this->find(handle.index);
+    if (s == nullptr) {
+        return task_status::unknown;
+    }
+
+    const spin_lock lock(s->busy);
+    return (s->generation == handle.generation) ? s->status : task_status::unknown;
+}
+
+handle_table::slot* handle_table::find(std::uint32_t index) const noexcept
+{
+    if (index >= this->m_size.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    return &this->m_chunks[index / chunk_size].load(std::memory_order_acquire)[index % chunk_size];
+}
+
+void handle_table::release(std::uint32_t index)
+{
+    const std::scoped_lock<std::mutex> lock(this->m_mutex);
+    this->m_free.push_back(index);
+}
+
+}  // namespace wwa
@@ -0,0 +1,62 @@
+#ifndef A48C88E1_EBAA_4413_8D43_F7309EFD33A7
+#define A48C88E1_EBAA_4413_8D43_F7309EFD33A7
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "threadpool.h"
+
+namespace wwa {
+
+struct work_item;
+
+// Slots for the tasks submitted with `thread_pool::post()`. Slots live in fixed-size chunks that are never moved
+// or freed before the table, so lookups need no table-wide lock; every slot is guarded by its own spin lock.
+// A released slot keeps the final status of its task until `acquire()` reuses it and bumps its generation.
+class handle_table {
+public:
+    static constexpr std::uint32_t no_slot = ~std::uint32_t{0};
+
+    handle_table() = default;
+    ~handle_table();
+
+    handle_table(const handle_table&)            = delete;
+    handle_table& operator=(const handle_table&) = delete;
+    handle_table(handle_table&&)                 = delete;
+    handle_table& operator=(handle_table&&)      = delete;
+
+    thread_pool::task_handle acquire(work_item* item);
+    // Marks the task as running; returns `false` and releases the slot if the task was canceled while queued
+    bool start(std::uint32_t index);
+    void finish(std::uint32_t index, thread_pool::task_status status);
+
+    bool cancel(thread_pool::task_handle handle) noexcept;
+    thread_pool::task_status status(thread_pool::task_handle handle) const noexcept;
+
+private:
+    static constexpr std::size_t chunk_size = 1024;
+    static constexpr std::size_t max_chunks = 4096;
+
+    struct slot {
+        mutable std::atomic_flag busy;
+        std::uint32_t generation        = 0;
+        thread_pool::task_status status = thread_pool::task_status::unknown;
+        work_item* item                 = nullptr;  // set while the task is queued or running
+    };
+
+    std::array<std::atomic<slot*>, max_chunks> m_chunks{};
+    std::atomic<std::uint32_t> m_size{0};
+    std::mutex m_mutex;
+    std::deque<std::uint32_t> m_free;  // oldest first, so that handles stay valid for as long as possible
+
+    slot* find(std::uint32_t index) const noexcept;
+    void release(std::uint32_t index);
+};
+
+}  // namespace wwa
+
+#endif /* A48C88E1_EBAA_4413_8D43_F7309EFD33A7 */
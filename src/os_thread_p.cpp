@@ -0,0 +1,173 @@
+#include "os_thread_p.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_PTHREAD
+#    include <climits>
+#    include <unistd.h>
+#endif
+
+#if __has_include(<alloca.h>)
+#    include <alloca.h>
+#    define WWA_SIMPLE_THREADPOOL_HAVE_ALLOCA
+#endif
+
+namespace {
+
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_PTHREAD
+// Linux limits thread names to 15 characters, macOS to 63
+#    ifdef __APPLE__
+constexpr std::size_t max_name_length = 63;
+#    else
+constexpr std::size_t max_name_length = 15;
+#    endif
+
+struct start_data {
+    wwa::os_thread::function_t fn;
+    std::stop_token token;
+    std::string name;
+};
+
+void* thread_start(void* arg)
+{
+    const std::unique_ptr<start_data> data(static_cast<start_data*>(arg));
+    if (!data->name.empty()) {
+#    ifdef __APPLE__
+        pthread_setname_np(data->name.c_str());
+#    elif defined(__linux__) || defined(__FreeBSD__)
+        pthread_setname_np(pthread_self(), data->name.c_str());
+#    endif
+    }
+
+    // Like `std::thread`, an escaping exception terminates the program: `thread_start()` is `noexcept` in effect
+    [&data]() noexcept { data->fn(data->token); }();
+    return nullptr;
+}
+
+std::size_t page_size() noexcept
+{
+    const auto size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? static_cast<std::size_t>(size) : 4096U;
+}
+#endif
+
+}  // namespace
+
+namespace wwa {
+
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_PTHREAD
+os_thread::os_thread(const thread_attributes& attrs, function_t fn)
+{
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (attrs.stack_size != 0) {
+        const auto page  = page_size();
+        const auto size  = std::max<std::size_t>(attrs.stack_size, PTHREAD_STACK_MIN);
+        const auto round = (size + page - 1) / page * page;
+        pthread_attr_setstacksize(&attr, round);
+    }
+
+    auto data = std::make_unique<start_data>(
+        std::move(fn), this->m_stop_source.get_token(), attrs.name.substr(0, max_name_length)
+    );
+
+    const int res = pthread_create(&this->m_handle, &attr, thread_start, data.get());
+    pthread_attr_destroy(&attr);
+    if (res != 0) {
+        throw std::system_error(res, std::generic_category(), "pthread_create");
+    }
+
+    static_cast<void>(data.release());
+    this->m_joinable = true;
+}
+
+os_thread::os_thread(os_thread&& other) noexcept
+    : m_stop_source(std::move(other.m_stop_source)), m_handle(other.m_handle),
+      m_joinable(std::exchange(other.m_joinable, false))
+{
+}
+
+bool os_thread::joinable() const noexcept
+{
+    return this->m_joinable;
+}
+
+void os_thread::join()
+{
+    if (!this->m_joinable) {
+        throw std::system_error(std::make_error_code(std::errc::invalid_argument), "os_thread::join");
+    }
+
+    const int res = pthread_join(this->m_handle, nullptr);
+    if (res != 0) {
+        throw std::system_error(res, std::generic_category(), "pthread_join");
+    }
+
+    this->m_joinable = false;
+}
+#else
+os_thread::os_thread(const thread_attributes&, function_t fn)
+    : m_thread([fn = std::move(fn), token = this->m_stop_source.get_token()] { fn(token); })
+{
+}
+
+os_thread::os_thread(os_thread&& other) noexcept
+    : m_stop_source(std::move(other.m_stop_source)), m_thread(std::move(other.m_thread))
+{
+}
+
+bool os_thread::joinable() const noexcept
+{
+    return this->m_thread.joinable();
+}
+
+void os_thread::join()
+{
+    this->m_thread.join();
+}
+#endif
+
+os_thread::~os_thread()
+{
+    if (this->joinable()) {
+        this->request_stop();
+        this->join();
+    }
+}
+
+void os_thread::prefault_stack() noexcept
+{
+#if defined(__linux__) && defined(WWA_SIMPLE_THREADPOOL_HAVE_ALLOCA)
+    pthread_attr_t attr;
+    void* addr       = nullptr;
+    std::size_t size = 0;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return;
+    }
+
+    pthread_attr_getstack(&attr, &addr, &size);
+    pthread_attr_destroy(&attr);
+
+    // The stack grows down from here to `addr`; leave room for whatever the caller does next
+    constexpr std::size_t headroom = std::size_t{64} * 1024U;
+    const char marker              = 0;
+
+    const auto here      = reinterpret_cast<std::uintptr_t>(&marker);
+    const auto available = here - reinterpret_cast<std::uintptr_t>(addr);
+    if (available <= headroom) {
+        return;
+    }
+
+    const auto page = page_size();
+    auto* stack     = static_cast<volatile char*>(alloca(available - headroom));
+    for (std::size_t offset = 0; offset < available - headroom; offset += page) {
+        stack[offset] = 0;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+#endif
+}
+
+}  // namespace wwa
@@ -0,0 +1,55 @@
+#ifndef E6AE1B7C_59FF_4346_8BDA_2B0F4DD1AF72
+#define E6AE1B7C_59FF_4346_8BDA_2B0F4DD1AF72
+
+#include <cstddef>
+#include <functional>
+#include <stop_token>
+#include <string>
+
+#if __has_include(<pthread.h>)
+#    define WWA_SIMPLE_THREADPOOL_HAVE_PTHREAD
+#    include <pthread.h>
+#else
+#    include <thread>
+#endif
+
+namespace wwa {
+
+struct thread_attributes {
+    std::size_t stack_size = 0;  // 0 keeps the system default
+    std::string name;            // empty keeps the inherited name; truncated to what the OS allows
+};
+
+// `std::jthread` look-alike whose stack size and name can be set. Without pthreads, both are ignored.
+class os_thread {
+public:
+    using function_t = std::function<void(const std::stop_token&)>;
+
+    os_thread(const thread_attributes& attrs, function_t fn);
+    ~os_thread();
+
+    os_thread(const os_thread&)            = delete;
+    os_thread& operator=(const os_thread&) = delete;
+    os_thread(os_thread&& other) noexcept;
+    os_thread& operator=(os_thread&&) = delete;
+
+    [[nodiscard]] bool joinable() const noexcept;
+    void join();
+    void request_stop() noexcept { this->m_stop_source.request_stop(); }
+
+    // Commits the unused part of the calling thread's stack ahead of time; only implemented on Linux
+    static void prefault_stack() noexcept;
+
+private:
+    std::stop_source m_stop_source;
+#ifdef WWA_SIMPLE_THREADPOOL_HAVE_PTHREAD
+    pthread_t m_handle{};
+    bool m_joinable = false;
+#else
+    std::thread m_thread;
+#endif
+};
+
+}  // namespace wwa
+
+#endif /* E6AE1B7C_59FF_4346_8BDA_2B0F4DD1AF72 */
@@ -0,0 +1,27 @@
+#include "strand.h"
+#include "strand_p.h"
+
+#include <memory>
+#include <stdexcept>
+
+namespace wwa {
+
+strand::strand(thread_pool& pool) : m_impl(std::make_shared<strand_private>(pool)) {}
+
+strand::~strand() = default;
+
+void strand::post(const thread_pool::worker_t& worker, const thread_pool::after_work_t& after_work)
+{
+    if (worker == nullptr) {
+        throw std::invalid_argument("worker cannot be null");
+    }
+
+    this->m_impl->post(worker, after_work);
+}
+
+bool strand::running_in_this_thread() const noexcept
+{
+    return this->m_impl->running_in_this_thread();
+}
+
+}  // namespace wwa
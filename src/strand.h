@@ -0,0 +1,40 @@
+#ifndef F2A94C61_8E3B_4D05_B7A1_9C6E2D4F8B30
+#define F2A94C61_8E3B_4D05_B7A1_9C6E2D4F8B30
+
+#include <memory>
+
+#include "export.h"
+#include "threadpool.h"
+
+namespace wwa {
+
+class strand_private;
+
+// Runs the tasks posted to it one at a time, in FIFO order, on the workers of a `thread_pool`. Posting never blocks:
+// an idle strand submits a single task to the pool, which keeps running the strand's tasks on the same worker
+// for as long as there are any (up to a fairness budget, after which it goes back to the end of the pool's queue).
+// Each task gets the stop token of that pool task. An idle strand holds no pool resources.
+// A task that throws is reported like any other pool task (`tasks_failed()`, `recent_failures()`, the error handler);
+// the strand's next task then runs in a new pool task. When the pool cancels the strand's pool task, or
+// `shutdown_now()` hands it back and the caller drops it, the queued tasks are canceled. Like `submit()`,
+// `post()` throws `std::runtime_error` if it needs a new pool task and the pool no longer accepts work.
+class WWA_SIMPLE_THREADPOOL_EXPORT strand {
+public:
+    explicit strand(thread_pool& pool);
+    ~strand();
+
+    strand(const strand&)                = delete;
+    strand& operator=(const strand&)     = delete;
+    strand(strand&&) noexcept            = default;
+    strand& operator=(strand&&) noexcept = default;
+
+    void post(const thread_pool::worker_t& worker, const thread_pool::after_work_t& after_work = nullptr);
+    [[nodiscard]] bool running_in_this_thread() const noexcept;
+
+private:
+    std::shared_ptr<strand_private> m_impl;
+};
+
+}  // namespace wwa
+
+#endif /* F2A94C61_8E3B_4D05_B7A1_9C6E2D4F8B30 */
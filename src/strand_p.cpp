@@ -0,0 +1,190 @@
+#include "strand_p.h"
+#include "threadpool_p.h"
+
+#include <exception>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace {
+
+thread_local const wwa::strand_private* current_strand = nullptr;
+
+}  // namespace
+
+namespace wwa {
+
+strand_private::~strand_private()
+{
+    while (auto* item = this->pop()) {
+        delete item;  // NOLINT(cppcoreguidelines-owning-memory)
+    }
+}
+
+void strand_private::post(const thread_pool::worker_t& worker, const thread_pool::after_work_t& after_work)
+{
+    this->push(new node(worker, after_work));  // NOLINT(cppcoreguidelines-owning-memory)
+    if (!this->m_scheduled.exchange(true)) {
+        this->schedule();
+    }
+}
+
+bool strand_private::running_in_this_thread() const noexcept
+{
+    return current_strand == this;
+}
+
+void strand_private::push(node_base* n) noexcept
+{
+    n->next.store(nullptr, std::memory_order_relaxed);
+    auto* prev = this->m_head.exchange(n);
+    prev->next.store(n, std::memory_order_release);
+}
+
+strand_private::node* strand_private::pop() noexcept
+{
+    node_base* tail = this->m_tail;
+    node_base* next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &this->m_stub) {
+        if (next == nullptr) {
+            return nullptr;
+        }
+
+        this->m_tail = next;
+        tail         = next;
+        next         = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next == nullptr) {
+        if (tail != this->m_head.load()) {
+            // A producer has not linked its node yet
+            return nullptr;
+        }
+
+        this->push(&this->m_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return nullptr;
+        }
+    }
+
+    this->m_tail = next;
+    return static_cast<node*>(tail);
+}
+
+bool strand_private::release() noexcept
+{
+    // `m_tail` belongs to the owner and is read before giving up ownership: once `m_scheduled` is cleared,
+    // another worker may start draining. After that, only `m_head` tells whether producers have added anything
+    const bool drained = this->m_tail == &this->m_stub;
+    this->m_scheduled.store(false);
+    return (drained && this->m_head.load() == &this->m_stub) || this->m_scheduled.exchange(true);
+}
+
+void strand_private::schedule()
+{
+    // The ticket goes with both callbacks, so the strand outlives whichever of them the caller keeps
+    auto ticket = std::make_shared<drain_ticket>(this->shared_from_this());
+    try {
+        this->m_pool.submit(
+            [ticket](const std::stop_token& token) { ticket->take()->drain(token); },
+            [ticket](bool canceled) {
+                if (const auto self = ticket->take(); self && canceled) {
+                    self->cancel_all();
+                }
+            }
+        );
+    }
+    catch (...) {
+        ticket->take();
+        this->cancel_all();
+        throw;
+    }
+}
+
+void strand_private::drain(const std::stop_token& token)
+{
+    const auto* prev = std::exchange(current_strand, this);
+    std::exception_ptr error;
+    std::size_t done = 0;
+
+    while (true) {
+        if (const std::unique_ptr<node> item{this->pop()}; item) {
+            try {
+                item->worker(token);
+                if (item->after_work) {
+                    item->after_work(false);
+                }
+            }
+            catch (...) {
+                error = std::current_exception();
+                if (item->after_work) {
+                    item->after_work(false);
+                }
+            }
+
+            thread_pool_private::reset_current_arena();
+            if (error || ++done == strand_private::budget) {
+                break;
+            }
+
+            continue;
+        }
+
+        if (this->release()) {
+            current_strand = prev;
+            return;
+        }
+
+        // A producer is between publishing its node and linking it
+        std::this_thread::yield();
+    }
+
+    // Let other pool work run and report the failure to the pool; the rest of the queue runs in a new pool task
+    current_strand = prev;
+    if (!this->release()) {
+        try {
+            this->schedule();
+        }
+        catch (...) {  // NOLINT(bugprone-empty-catch)
+            // The pool no longer accepts work; the remaining tasks have been canceled
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void strand_private::cancel_all()
+{
+    while (true) {
+        while (const std::unique_ptr<node> item{this->pop()}) {
+            if (item->after_work) {
+                item->after_work(true);
+            }
+        }
+
+        if (this->release()) {
+            return;
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+strand_private::drain_ticket::~drain_ticket()
+{
+    // Neither callback was called: the pool handed the task back from `shutdown_now()` and the caller dropped it
+    if (this->m_strand) {
+        this->m_strand->cancel_all();
+    }
+}
+
+std::shared_ptr<strand_private> strand_private::drain_ticket::take() noexcept
+{
+    return std::exchange(this->m_strand, nullptr);
+}
+
+}  // namespace wwa
@@ -0,0 +1,78 @@
+#ifndef A05D7E93_2B6C_4F1A_8D47_E3C9B1F6A258
+#define A05D7E93_2B6C_4F1A_8D47_E3C9B1F6A258
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stop_token>
+#include <utility>
+
+#include "threadpool.h"
+
+namespace wwa {
+
+class strand_private : public std::enable_shared_from_this<strand_private> {
+public:
+    explicit strand_private(thread_pool& pool) : m_pool(pool) {}
+    ~strand_private();
+
+    strand_private(const strand_private&)                = delete;
+    strand_private& operator=(const strand_private&)     = delete;
+    strand_private(strand_private&&) noexcept            = delete;
+    strand_private& operator=(strand_private&&) noexcept = delete;
+
+    void post(const thread_pool::worker_t& worker, const thread_pool::after_work_t& after_work);
+    bool running_in_this_thread() const noexcept;
+
+private:
+    struct node_base {
+        std::atomic<node_base*> next{nullptr};
+    };
+
+    struct node : node_base {
+        thread_pool::worker_t worker;
+        thread_pool::after_work_t after_work;
+
+        node(const thread_pool::worker_t& w, const thread_pool::after_work_t& a) : worker(w), after_work(a) {}
+    };
+
+    // Ownership of the strand that goes with its pool task, until the task runs or is canceled
+    class drain_ticket {
+    public:
+        explicit drain_ticket(std::shared_ptr<strand_private> strand) : m_strand(std::move(strand)) {}
+        ~drain_ticket();
+
+        drain_ticket(const drain_ticket&)            = delete;
+        drain_ticket& operator=(const drain_ticket&) = delete;
+        drain_ticket(drain_ticket&&)                 = delete;
+        drain_ticket& operator=(drain_ticket&&)      = delete;
+
+        std::shared_ptr<strand_private> take() noexcept;
+
+    private:
+        std::shared_ptr<strand_private> m_strand;
+    };
+
+    // Tasks run on the same worker before the strand yields it to other pool work
+    static constexpr std::size_t budget = 64;
+
+    thread_pool& m_pool;
+    // Intrusive multi-producer, single-consumer queue (D. Vyukov): producers only exchange `m_head`,
+    // the consumer is whoever currently owns `m_scheduled`
+    node_base m_stub;
+    std::atomic<node_base*> m_head{&m_stub};
+    node_base* m_tail = &m_stub;
+    std::atomic<bool> m_scheduled{false};
+
+    void push(node_base* n) noexcept;
+    node* pop() noexcept;
+    bool release() noexcept;
+
+    void schedule();
+    void drain(const std::stop_token& token);
+    void cancel_all();
+};
+
+}  // namespace wwa
+
+#endif /* A05D7E93_2B6C_4F1A_8D47_E3C9B1F6A258 */
@@ -0,0 +1,77 @@
+#include "task_graph.h"
+#include "task_graph_p.h"
+
+#include <memory>
+#include <stdexcept>
+
+namespace wwa {
+
+task_graph::task_graph() : m_impl(std::make_unique<task_graph_private>()) {}
+
+task_graph::~task_graph() = default;
+
+task_graph::node_t task_graph::add_node(const thread_pool::worker_t& worker)
+{
+    if (worker == nullptr) {
+        throw std::invalid_argument("worker cannot be null");
+    }
+
+    return this->m_impl->add_node(worker);
+}
+
+void task_graph::add_edge(node_t from, node_t to)
+{
+    this->m_impl->add_edge(from, to);
+}
+
+void task_graph::run(thread_pool& pool)
+{
+    this->m_impl->run(pool);
+}
+
+void task_graph::cancel()
+{
+    this->m_impl->cancel();
+}
+
+void task_graph::wait()
+{
+    this->m_impl->wait();
+}
+
+bool task_graph::wait_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time)
+{
+    return this->m_impl->wait_until(abs_time);
+}
+
+bool task_graph::running() const noexcept
+{
+    return this->m_impl->running();
+}
+
+std::size_t task_graph::size() const noexcept
+{
+    return this->m_impl->size();
+}
+
+std::size_t task_graph::nodes_completed() const noexcept
+{
+    return this->m_impl->nodes_completed();
+}
+
+std::size_t task_graph::nodes_failed() const noexcept
+{
+    return this->m_impl->nodes_failed();
+}
+
+std::size_t task_graph::nodes_skipped() const noexcept
+{
+    return this->m_impl->nodes_skipped();
+}
+
+std::exception_ptr task_graph::exception() const
+{
+    return this->m_impl->exception();
+}
+
+}  // namespace wwa
@@ -0,0 +1,60 @@
+#ifndef A6C0F3E1_5D7B_4F1C_9E2A_7B3D8C41E5F0
+#define A6C0F3E1_5D7B_4F1C_9E2A_7B3D8C41E5F0
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+
+#include "export.h"
+#include "threadpool.h"
+
+namespace wwa {
+
+class task_graph_private;
+
+// A node runs once all its predecessors have finished. The worker that finishes a node runs the first successor
+// it makes ready itself and submits the others to the pool. If a node throws or the run is canceled, the nodes
+// depending on it are skipped. Shutting the pool down while a node runs cancels the run, just like `cancel()` does.
+// The graph can be run again once the previous run is over.
+class WWA_SIMPLE_THREADPOOL_EXPORT task_graph {
+public:
+    using node_t = std::size_t;
+
+    task_graph();
+    ~task_graph();
+
+    task_graph(const task_graph&)                = delete;
+    task_graph& operator=(const task_graph&)     = delete;
+    task_graph(task_graph&&) noexcept            = default;
+    task_graph& operator=(task_graph&&) noexcept = default;
+
+    node_t add_node(const thread_pool::worker_t& worker);
+    void add_edge(node_t from, node_t to);
+
+    void run(thread_pool& pool);
+    void cancel();
+    void wait();
+
+    template<typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& rel_time)
+    {
+        return this->wait_until(std::chrono::steady_clock::now() + rel_time);
+    }
+
+    bool wait_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time);
+
+    [[nodiscard]] bool running() const noexcept;
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::size_t nodes_completed() const noexcept;
+    [[nodiscard]] std::size_t nodes_failed() const noexcept;
+    [[nodiscard]] std::size_t nodes_skipped() const noexcept;
+    [[nodiscard]] std::exception_ptr exception() const;
+
+private:
+    std::unique_ptr<task_graph_private> m_impl;
+};
+
+}  // namespace wwa
+
+#endif /* A6C0F3E1_5D7B_4F1C_9E2A_7B3D8C41E5F0 */
@@ -0,0 +1,303 @@
+#include "task_graph_p.h"
+#include "task_graph.h"
+#include "threadpool_p.h"
+
+#include <exception>
+#include <stop_token>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace wwa {
+
+using unique_lock = std::unique_lock<std::mutex>;
+
+task_graph_private::~task_graph_private()
+{
+    this->wait();
+}
+
+task_graph::node_t task_graph_private::add_node(const thread_pool::worker_t& worker)
+{
+    this->ensure_idle();
+    this->m_nodes.emplace_back(worker);
+    this->m_validated = false;
+    return this->m_nodes.size() - 1;
+}
+
+void task_graph_private::add_edge(task_graph::node_t from, task_graph::node_t to)
+{
+    this->ensure_idle();
+    if (from >= this->m_nodes.size() || to >= this->m_nodes.size()) {
+        throw std::out_of_range("invalid node");
+    }
+
+    if (from == to) {
+        throw std::invalid_argument("a node cannot depend on itself");
+    }
+
+    this->m_nodes[from].successors.push_back(to);
+    ++this->m_nodes[to].in_degree;
+    this->m_validated = false;
+}
+
+void task_graph_private::run(thread_pool& pool)
+{
+    this->ensure_idle();
+    this->validate();
+
+    if (this->m_nodes.empty()) {
+        return;
+    }
+
+    if (this->m_stop_source.stop_requested()) {
+        this->m_stop_source = std::stop_source();
+    }
+
+    for (auto& node : this->m_nodes) {
+        node.pending.store(node.in_degree, std::memory_order_relaxed);
+        node.poisoned.store(false, std::memory_order_relaxed);
+    }
+
+    {
+        const std::scoped_lock<std::mutex> lock(this->m_mutex);
+        this->m_exception = nullptr;
+        this->m_running   = true;
+    }
+
+    this->m_nodes_completed = 0;
+    this->m_nodes_failed    = 0;
+    this->m_nodes_skipped   = 0;
+    this->m_pool            = &pool;
+    this->m_remaining.store(this->m_nodes.size(), std::memory_order_release);
+
+    for (auto it = this->m_roots.begin(); it != this->m_roots.end(); ++it) {
+        try {
+            this->schedule(*it);
+        }
+        catch (...) {
+            // Roots that could not be submitted are skipped along with everything depending on them,
+            // so that the run still completes.
+            for (; it != this->m_roots.end(); ++it) {
+                this->skip(*it);
+            }
+
+            throw;
+        }
+    }
+}
+
+void task_graph_private::cancel()
+{
+    if (this->m_running) {
+        this->m_stop_source.request_stop();
+    }
+}
+
+void task_graph_private::wait()
+{
+    unique_lock lock(this->m_mutex);
+    this->m_done_cv.wait(lock, [this] { return !this->m_running; });
+}
+
+bool task_graph_private::wait_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time)
+{
+    unique_lock lock(this->m_mutex);
+    return this->m_done_cv.wait_until(lock, abs_time, [this] { return !this->m_running; });
+}
+
+bool task_graph_private::running() const noexcept
+{
+    return this->m_running;
+}
+
+std::size_t task_graph_private::size() const noexcept
+{
+    return this->m_nodes.size();
+}
+
+std::size_t task_graph_private::nodes_completed() const noexcept
+{
+    return this->m_nodes_completed;
+}
+
+std::size_t task_graph_private::nodes_failed() const noexcept
+{
+    return this->m_nodes_failed;
+}
+
+std::size_t task_graph_private::nodes_skipped() const noexcept
+{
+    return this->m_nodes_skipped;
+}
+
+std::exception_ptr task_graph_private::exception() const
+{
+    const std::scoped_lock<std::mutex> lock(this->m_mutex);
+    return this->m_exception;
+}
+
+void task_graph_private::validate()
+{
+    if (this->m_validated) {
+        return;
+    }
+
+    std::vector<std::size_t> in_degree;
+    in_degree.reserve(this->m_nodes.size());
+    this->m_roots.clear();
+    for (std::size_t i = 0; i < this->m_nodes.size(); ++i) {
+        in_degree.push_back(this->m_nodes[i].in_degree);
+        if (in_degree.back() == 0) {
+            this->m_roots.push_back(i);
+        }
+    }
+
+    // Kahn's algorithm: every node must become ready at some point, otherwise there is a cycle
+    std::vector<task_graph::node_t> ready(this->m_roots);
+    std::size_t visited = 0;
+    while (!ready.empty()) {
+        auto id = ready.back();
+        ready.pop_back();
+        ++visited;
+
+        for (auto successor : this->m_nodes[id].successors) {
+            if (--in_degree[successor] == 0) {
+                ready.push_back(successor);
+            }
+        }
+    }
+
+    if (visited != this->m_nodes.size()) {
+        throw std::logic_error("task graph contains a cycle");
+    }
+
+    this->m_validated = true;
+}
+
+void task_graph_private::schedule(task_graph::node_t id)
+{
+    // The ticket goes with both callbacks: if the pool cancels the node, or `shutdown_now()` hands it back and
+    // the caller drops it, the node and its dependents are skipped so that the run still completes
+    auto ticket = std::make_shared<node_ticket>(this, id);
+    try {
+        this->m_pool->submit(
+            [ticket, id](const std::stop_token& token) { ticket->take()->execute(id, token); },
+            [ticket, id](bool canceled) {
+                if (auto* self = ticket->take(); self != nullptr && canceled) {
+                    self->skip(id);
+                }
+            }
+        );
+    }
+    catch (...) {
+        ticket->take();
+        throw;
+    }
+}
+
+void task_graph_private::skip(task_graph::node_t id)
+{
+    this->m_nodes[id].poisoned.store(true, std::memory_order_relaxed);
+    this->execute(id);
+}
+
+void task_graph_private::execute(task_graph::node_t id, const std::stop_token& pool_token)
+{
+    while (id != no_node) {
+        auto& node  = this->m_nodes[id];
+        bool failed = true;
+
+        {
+            // A stop requested on the pool task (pool shutdown) stops the whole run. The callback is gone before
+            // the node is counted as finished, since the graph may be destroyed right after the last one
+            const std::stop_callback forward(pool_token, [this] { this->m_stop_source.request_stop(); });
+            if (node.poisoned.load(std::memory_order_relaxed) || this->m_stop_source.stop_requested()) {
+                this->m_nodes_skipped.fetch_add(1U, std::memory_order_relaxed);
+            }
+            else {
+                try {
+                    node.worker(this->m_stop_source.get_token());
+                    this->m_nodes_completed.fetch_add(1U, std::memory_order_relaxed);
+                    failed = false;
+                }
+                catch (...) {
+                    this->m_nodes_failed.fetch_add(1U, std::memory_order_relaxed);
+                    const std::scoped_lock<std::mutex> lock(this->m_mutex);
+                    if (!this->m_exception) {
+                        this->m_exception = std::current_exception();
+                    }
+                }
+
+                thread_pool_private::reset_current_arena();
+            }
+        }
+
+        auto next = this->release_successors(id, failed);
+        this->node_finished();
+        id = next;
+    }
+}
+
+task_graph::node_t task_graph_private::release_successors(task_graph::node_t id, bool poison)
+{
+    task_graph::node_t next = no_node;
+    for (auto successor_id : this->m_nodes[id].successors) {
+        auto& successor = this->m_nodes[successor_id];
+        if (poison) {
+            successor.poisoned.store(true, std::memory_order_relaxed);
+        }
+
+        if (successor.pending.fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+            if (next == no_node) {
+                // Continuation: the current worker runs the first ready successor itself
+                next = successor_id;
+            }
+            else if (successor.poisoned.load(std::memory_order_relaxed)) {
+                this->execute(successor_id);
+            }
+            else {
+                try {
+                    this->schedule(successor_id);
+                }
+                catch (...) {
+                    // The pool no longer accepts work
+                    this->skip(successor_id);
+                }
+            }
+        }
+    }
+
+    return next;
+}
+
+void task_graph_private::node_finished()
+{
+    if (this->m_remaining.fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+        const std::scoped_lock<std::mutex> lock(this->m_mutex);
+        this->m_running = false;
+        this->m_done_cv.notify_all();
+    }
+}
+
+task_graph_private::node_ticket::~node_ticket()
+{
+    // Neither callback was called: the pool handed the task back from `shutdown_now()` and the caller dropped it
+    if (this->m_graph != nullptr) {
+        this->m_graph->skip(this->m_id);
+    }
+}
+
+task_graph_private* task_graph_private::node_ticket::take() noexcept
+{
+    return std::exchange(this->m_graph, nullptr);
+}
+
+void task_graph_private::ensure_idle() const
+{
+    if (this->m_running) {
+        throw std::logic_error("task graph is running");
+    }
+}
+
+}  // namespace wwa
@@ -0,0 +1,101 @@
+#ifndef C4E1B7A2_9F3D_4A60_8B5C_2E7D1F09A3B6
+#define C4E1B7A2_9F3D_4A60_8B5C_2E7D1F09A3B6
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stop_token>
+#include <vector>
+
+#include "task_graph.h"
+#include "threadpool.h"
+
+namespace wwa {
+
+class task_graph_private {
+public:
+    task_graph_private()  = default;
+    ~task_graph_private();
+
+    task_graph_private(const task_graph_private&)                = delete;
+    task_graph_private& operator=(const task_graph_private&)     = delete;
+    task_graph_private(task_graph_private&&) noexcept            = delete;
+    task_graph_private& operator=(task_graph_private&&) noexcept = delete;
+
+    task_graph::node_t add_node(const thread_pool::worker_t& worker);
+    void add_edge(task_graph::node_t from, task_graph::node_t to);
+
+    void run(thread_pool& pool);
+    void cancel();
+    void wait();
+    bool wait_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time);
+
+    bool running() const noexcept;
+    std::size_t size() const noexcept;
+    std::size_t nodes_completed() const noexcept;
+    std::size_t nodes_failed() const noexcept;
+    std::size_t nodes_skipped() const noexcept;
+    std::exception_ptr exception() const;
+
+private:
+    struct node {
+        thread_pool::worker_t worker;
+        std::vector<task_graph::node_t> successors;
+        std::size_t in_degree = 0;
+        std::atomic<std::size_t> pending{0};
+        std::atomic<bool> poisoned{false};
+
+        explicit node(const thread_pool::worker_t& w) : worker(w) {}
+    };
+
+    // Ownership of a submitted node that goes with its pool task, until the task runs or is canceled
+    class node_ticket {
+    public:
+        node_ticket(task_graph_private* graph, task_graph::node_t id) : m_graph(graph), m_id(id) {}
+        ~node_ticket();
+
+        node_ticket(const node_ticket&)            = delete;
+        node_ticket& operator=(const node_ticket&) = delete;
+        node_ticket(node_ticket&&)                 = delete;
+        node_ticket& operator=(node_ticket&&)      = delete;
+
+        task_graph_private* take() noexcept;
+
+    private:
+        task_graph_private* m_graph;
+        task_graph::node_t m_id;
+    };
+
+    static constexpr task_graph::node_t no_node = static_cast<task_graph::node_t>(-1);
+
+    std::deque<node> m_nodes;
+    std::vector<task_graph::node_t> m_roots;
+    bool m_validated = true;
+
+    thread_pool* m_pool = nullptr;
+    std::stop_source m_stop_source;
+    std::atomic<std::size_t> m_remaining{0};
+    std::atomic<bool> m_running{false};
+    std::atomic<std::size_t> m_nodes_completed{0};
+    std::atomic<std::size_t> m_nodes_failed{0};
+    std::atomic<std::size_t> m_nodes_skipped{0};
+    std::exception_ptr m_exception;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_done_cv;
+
+    void validate();
+    void schedule(task_graph::node_t id);
+    void skip(task_graph::node_t id);
+    void execute(task_graph::node_t id, const std::stop_token& pool_token = {});
+    task_graph::node_t release_successors(task_graph::node_t id, bool poison);
+    void node_finished();
+    void ensure_idle() const;
+};
+
+}  // namespace wwa
+
+#endif /* C4E1B7A2_9F3D_4A60_8B5C_2E7D1F09A3B6 */
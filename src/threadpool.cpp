@@ -6,10 +6,21 @@
 
 namespace wwa {
 
-thread_pool::thread_pool(std::size_t n) : m_impl(std::make_unique<thread_pool_private>(n)) {}
+thread_pool::thread_pool(std::size_t n) : thread_pool(options{.num_threads = n}) {}
+
+thread_pool::thread_pool(const options& opts) : m_impl(std::make_unique<thread_pool_private>(opts)) {}
 
 thread_pool::~thread_pool() = default;
 
+thread_pool::blocking_scope::blocking_scope() : m_pool(thread_pool_private::begin_blocking()) {}
+
+thread_pool::blocking_scope::~blocking_scope()
+{
+    if (this->m_pool != nullptr) {
+        this->m_pool->end_blocking();
+    }
+}
+
 thread_pool::task_t thread_pool::submit(const worker_t& worker, const after_work_t& after_work)
 {
     if (worker == nullptr) {
@@ -24,6 +35,40 @@ bool thread_pool::cancel(const thread_pool::task_t& task)
     return this->m_impl->cancel(task);
 }
 
+thread_pool::task_handle thread_pool::post(const worker_t& worker, const after_work_t& after_work)
+{
+    if (worker == nullptr) {
+        throw std::invalid_argument("worker cannot be null");
+    }
+
+    return this->m_impl->post(worker, after_work);
+}
+
+bool thread_pool::cancel(task_handle handle)
+{
+    return this->m_impl->cancel(handle);
+}
+
+thread_pool::task_status thread_pool::status(task_handle handle) const noexcept
+{
+    return this->m_impl->status(handle);
+}
+
+void thread_pool::shutdown()
+{
+    this->m_impl->shutdown();
+}
+
+std::vector<thread_pool::pending_task> thread_pool::shutdown_now()
+{
+    return this->m_impl->shutdown_now();
+}
+
+bool thread_pool::shutdown_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time)
+{
+    return this->m_impl->shutdown_until(abs_time);
+}
+
 void thread_pool::wait()
 {
     this->m_impl->wait();
@@ -49,6 +94,11 @@ std::size_t thread_pool::max_active_threads() const noexcept
     return this->m_impl->max_active_threads();
 }
 
+std::size_t thread_pool::blocked_threads() const noexcept
+{
+    return this->m_impl->blocked_threads();
+}
+
 std::size_t thread_pool::work_queue_size() const
 {
     return this->m_impl->work_queue_size();
@@ -74,4 +124,58 @@ std::size_t thread_pool::tasks_canceled() const noexcept
     return this->m_impl->tasks_canceled();
 }
 
+std::size_t thread_pool::arena_overflows() const noexcept
+{
+    return this->m_impl->arena_overflows();
+}
+
+void thread_pool::set_error_handler(const error_handler_t& handler)
+{
+    this->m_impl->set_error_handler(handler);
+}
+
+std::vector<thread_pool::failure_record> thread_pool::recent_failures() const
+{
+    return this->m_impl->recent_failures();
+}
+
+thread_pool::load_stats thread_pool::load() const
+{
+    return this->m_impl->load();
+}
+
+void thread_pool::set_load_window(std::chrono::steady_clock::duration window)
+{
+    if (window <= std::chrono::steady_clock::duration::zero()) {
+        throw std::invalid_argument("load window must be positive");
+    }
+
+    this->m_impl->set_load_window(window);
+}
+
+void thread_pool::enable_tracing(bool enable)
+{
+    this->m_impl->enable_tracing(enable);
+}
+
+bool thread_pool::tracing_enabled() const noexcept
+{
+    return this->m_impl->tracing_enabled();
+}
+
+void thread_pool::dump_trace(std::ostream& os) const
+{
+    this->m_impl->dump_trace(os);
+}
+
+thread_pool::contention_stats thread_pool::contention() const noexcept
+{
+    return this->m_impl->contention();
+}
+
+std::pmr::memory_resource* this_worker::arena() noexcept
+{
+    return thread_pool_private::current_arena();
+}
+
 }  // namespace wwa
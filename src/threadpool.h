@@ -3,9 +3,16 @@
 
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <iosfwd>
 #include <memory>
+#include <memory_resource>
 #include <stop_token>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "export.h"
 
@@ -16,11 +23,107 @@ struct work_item;
 class thread_pool_private;
 class WWA_SIMPLE_THREADPOOL_EXPORT thread_pool {
 public:
-    using task_t       = std::weak_ptr<work_item>;
-    using worker_t     = std::function<void(const std::stop_token&)>;
-    using after_work_t = std::function<void(bool)>;
+    using task_t          = std::weak_ptr<work_item>;
+    using worker_t        = std::function<void(const std::stop_token&)>;
+    using after_work_t    = std::function<void(bool)>;
+    using error_handler_t = std::function<void(const std::exception_ptr&)>;
+
+    struct failure_record {
+        std::chrono::steady_clock::time_point timestamp;
+        std::exception_ptr exception;
+    };
+
+    // Refers to a task submitted with `post()`: a slot in the pool's task table plus the slot's generation.
+    // Handles are plain values; they neither keep the task alive nor need to be released. A handle stays valid
+    // until its slot is reused by a later `post()`, after which it reports `task_status::unknown`.
+    struct task_handle {
+        std::uint32_t index      = 0;
+        std::uint32_t generation = 0;  // 0 never refers to a task
+
+        friend bool operator==(const task_handle&, const task_handle&) = default;
+    };
+
+    enum class task_status : std::uint8_t { unknown, queued, running, done, canceled };
+
+    struct pending_task {
+        worker_t worker;
+        after_work_t after_work;
+    };
+
+    // Exponentially weighted moving averages over the load window (one second by default)
+    struct load_stats {
+        double utilization       = 0;  // share of worker time spent running tasks, 0 to 1
+        double completion_rate   = 0;  // tasks finished (completed, failed or canceled) per second
+        double arrival_rate      = 0;  // tasks submitted per second
+        double queue_growth_rate = 0;  // change in queue length per second
+        std::size_t queue_length = 0;
+    };
+
+    // Queue lock and wakeup counters since the pool was created; only collected when the library is built
+    // with ENABLE_CONTENTION_PROFILING, all zero otherwise
+    struct contention_stats {
+        std::uint64_t lock_acquisitions      = 0;
+        std::uint64_t contended_acquisitions = 0;  // acquisitions that had to wait for another thread
+        std::chrono::nanoseconds lock_wait_time{0};
+        std::chrono::nanoseconds lock_hold_time{0};
+        std::uint64_t wakeups          = 0;  // idle workers woken up
+        std::uint64_t spurious_wakeups = 0;  // ...that found nothing to run: spurious, or another worker was faster
+        std::uint64_t notifications    = 0;  // notify calls made to wake up workers
+        std::uint64_t submissions      = 0;
+    };
+
+    struct options {
+        // 0 means one per hardware thread; with `shared_runtime`, the most runtime workers the pool may use at once
+        std::size_t num_threads = 0;
+        // The pool keeps its own queue, counters and shutdown state, but runs its tasks on a process-wide set of
+        // workers (one per hardware thread) shared with the other pools in this mode
+        bool shared_runtime = false;
+        // How many extra workers (runtime workers with `shared_runtime`) may stand in for workers blocked
+        // in a `blocking_scope`; 0 means `num_threads`
+        std::size_t max_spare_threads = 0;
+        // Workers move up to this many queued tasks into a private buffer per lock acquisition, fewer when
+        // the backlog is short; idle workers take unstarted tasks back from other workers' buffers.
+        // 1 disables batching. Ignored with `shared_runtime`
+        std::size_t max_batch = 1;
+        // Size of each worker's scratch arena (see `this_worker::arena()`); 0 disables the arenas
+        std::size_t arena_size = 0;
+        // Back the arenas with huge pages where the OS supports it (Linux); the size is rounded up to 2 MiB
+        bool arena_huge_pages = false;
+        // Workers are started once there is work for them, up to `num_threads`. With `warm_up`, the constructor
+        // starts all of them and returns once they have prefaulted their stacks and created their arenas
+        bool warm_up = false;
+        // Stack size of the pool's threads; 0 keeps the system default
+        std::size_t stack_size = 0;
+        // Threads are named "<thread_name>-<index>" (cut to 15 characters on Linux); empty keeps the inherited name
+        std::string thread_name{};
+    };
+
+    // Tells the pool that the current task is about to block (I/O, locks, waiting on a future). While the scope
+    // is alive, a spare worker takes over the blocked worker's share of the queue; once it ends, the spare parks
+    // again after its current task. Does nothing when not called from a task running on a pool.
+    class WWA_SIMPLE_THREADPOOL_EXPORT blocking_scope {
+    public:
+        blocking_scope();
+        ~blocking_scope();
+
+        blocking_scope(const blocking_scope&)            = delete;
+        blocking_scope& operator=(const blocking_scope&) = delete;
+        blocking_scope(blocking_scope&&)                 = delete;
+        blocking_scope& operator=(blocking_scope&&)      = delete;
+
+    private:
+        thread_pool_private* m_pool;
+    };
+
+    template<typename F>
+    static decltype(auto) managed_block(F&& fn)
+    {
+        const blocking_scope scope;
+        return std::forward<F>(fn)();
+    }
 
     explicit thread_pool(std::size_t n = 0);
+    explicit thread_pool(const options& opts);
     ~thread_pool();
 
     thread_pool(const thread_pool&)                = delete;
@@ -30,6 +133,30 @@ public:
 
     task_t submit(const worker_t& worker, const after_work_t& after_work = nullptr);
     bool cancel(const task_t& task);
+
+    // Like `submit()`, without allocating a `weak_ptr` control block for the caller. `cancel(handle)` is O(1):
+    // a queued task is marked and skipped when a worker reaches it (neither the task nor its `after_work` runs);
+    // for a running task, it requests a stop and returns `false`, just like `cancel(task_t)`.
+    task_handle post(const worker_t& worker, const after_work_t& after_work = nullptr);
+    bool cancel(task_handle handle);
+    [[nodiscard]] task_status status(task_handle handle) const noexcept;
+
+    // All shutdown modes stop accepting new work; `submit()` throws `std::runtime_error` afterwards.
+    // `shutdown()` lets the queued tasks run; tasks running on the pool may still submit follow-up work until then.
+    // `shutdown_now()` requests a stop on the running tasks and hands the queued ones back without running them.
+    // `shutdown_for()` and `shutdown_until()` drain the queue until the deadline and then cancel what is left;
+    // they return `false` if the deadline was hit.
+    void shutdown();
+    std::vector<pending_task> shutdown_now();
+
+    template<typename Rep, typename Period>
+    bool shutdown_for(const std::chrono::duration<Rep, Period>& rel_time)
+    {
+        return this->shutdown_until(std::chrono::steady_clock::now() + rel_time);
+    }
+
+    bool shutdown_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time);
+
     void wait();
 
     template<typename Rep, typename Period>
@@ -57,16 +184,47 @@ public:
     [[nodiscard]] std::size_t num_threads() const noexcept;
     [[nodiscard]] std::size_t active_threads() const noexcept;
     [[nodiscard]] std::size_t max_active_threads() const noexcept;
+    [[nodiscard]] std::size_t blocked_threads() const noexcept;
     [[nodiscard]] std::size_t work_queue_size() const;
     [[nodiscard]] std::size_t tasks_queued() const noexcept;
     [[nodiscard]] std::size_t tasks_completed() const noexcept;
     [[nodiscard]] std::size_t tasks_failed() const noexcept;
     [[nodiscard]] std::size_t tasks_canceled() const noexcept;
+    // Allocations the worker arenas served from the default memory resource because their buffer was full
+    [[nodiscard]] std::size_t arena_overflows() const noexcept;
+
+    // The handler is called on the worker thread for every task that throws, before the task's `after_work`;
+    // `std::current_exception()` still works inside `after_work`. Neither of them should throw.
+    void set_error_handler(const error_handler_t& handler);
+    // Up to the 64 most recent failures, oldest first
+    [[nodiscard]] std::vector<failure_record> recent_failures() const;
+
+    // Does not take the queue lock; cheap enough to be polled every few milliseconds
+    [[nodiscard]] load_stats load() const;
+    void set_load_window(std::chrono::steady_clock::duration window);
+
+    // Tracing is only available when the library is built with ENABLE_TRACING;
+    // otherwise `enable_tracing()` does nothing and `dump_trace()` writes an empty trace.
+    void enable_tracing(bool enable = true);
+    [[nodiscard]] bool tracing_enabled() const noexcept;
+    void dump_trace(std::ostream& os) const;
+
+    [[nodiscard]] contention_stats contention() const noexcept;
 
 private:
     std::unique_ptr<thread_pool_private> m_impl;
 };
 
+namespace this_worker {
+
+// Monotonic scratch memory of the worker running the current task, released after the task (and its `after_work`)
+// returns; nothing allocated from it may outlive the task. Tasks run by a `strand` and `task_graph` nodes count as
+// tasks of their own. Allocations that do not fit go to the default resource.
+// Returns `std::pmr::get_default_resource()` outside of pool tasks and when the pool has no arenas.
+WWA_SIMPLE_THREADPOOL_EXPORT std::pmr::memory_resource* arena() noexcept;
+
+}  // namespace this_worker
+
 }  // namespace wwa
 
 #endif /* DB57AD06_3B44_40FF_A554_841402EFC389 */
@@ -2,11 +2,40 @@
 #include "threadpool.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
 #include <exception>
+#include <iterator>
+#include <list>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <ostream>
+#include <latch>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <utility>
 
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_TRACING
+#    define WWA_TRACE(pool, type, item) (pool)->trace(wwa::trace_event::type, (item))
+#else
+#    define WWA_TRACE(pool, type, item) static_cast<void>(0)
+#endif
+
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_PROFILING
+#    define WWA_PROFILE(pool, counter) (pool)->m_contention.counter.fetch_add(1U, std::memory_order_relaxed)
+#else
+#    define WWA_PROFILE(pool, counter) static_cast<void>(0)
+#endif
+
 namespace {
 
+thread_local wwa::thread_pool_private* current_pool = nullptr;
+thread_local std::size_t current_worker             = 0;
+
 template<typename T>
 inline T atomic_fetch_max(std::atomic<T>& atomic_var, T new_value)
 {
@@ -24,54 +53,128 @@ void default_after_work(bool)
     // Do nothing
 }
 
+std::int64_t now_ns() noexcept
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
 }  // namespace
 namespace wwa {
 
-using unique_lock = std::unique_lock<std::mutex>;
-
-thread_pool_private::thread_pool_private(std::size_t n)
-    : m_num_threads((n == 0) ? std::thread::hardware_concurrency() : n)
+using unique_lock = std::unique_lock<queue_mutex>;
+
+thread_pool_private::thread_pool_private(const thread_pool::options& opts)
+    : m_runtime(opts.shared_runtime ? shared_runtime() : nullptr),
+      m_num_threads(
+          (opts.num_threads != 0) ? opts.num_threads
+          : this->m_runtime       ? this->m_runtime->m_num_threads
+                                  : std::thread::hardware_concurrency()
+      ),
+      m_max_spares((opts.max_spare_threads != 0) ? opts.max_spare_threads : this->m_num_threads),
+      m_max_batch(this->m_runtime ? 1 : std::max(opts.max_batch, std::size_t{1})),
+      m_thread_attrs{opts.stack_size, opts.thread_name}, m_arena_size(opts.arena_size),
+      m_arena_huge_pages(opts.arena_huge_pages)
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_TRACING
+    , m_tracer(this->num_slots())
+#endif
 {
-    this->m_threads.reserve(this->m_num_threads);
-    this->m_stop_sources.resize(this->m_num_threads);
-    for (std::size_t i = 0; i < this->m_num_threads; ++i) {
-        this->m_threads.emplace_back(worker_thread, this, i);
+    // Spare workers are started on demand, but their per-worker state is allocated up front
+    this->m_worker_states = std::make_unique<worker_state[]>(this->num_slots());  // NOLINT(*-avoid-c-arrays)
+    this->m_load_sample   = this->take_load_sample();
+    this->m_stop_sources.resize(this->num_slots());
+    if (this->m_max_batch > 1) {
+        this->m_buffers = std::make_unique<worker_buffer[]>(this->num_slots());  // NOLINT(*-avoid-c-arrays)
+    }
+
+    if (this->m_arena_size != 0) {
+        this->m_arenas.resize(this->num_slots());
+    }
+
+    if (this->m_runtime) {
+        this->m_free_slots.resize(this->num_slots());
+        std::iota(this->m_free_slots.begin(), this->m_free_slots.end(), std::size_t{0});
+        return;
+    }
+
+    this->m_threads.reserve(this->num_slots());
+    if (opts.warm_up) {
+        std::latch ready(static_cast<std::ptrdiff_t>(this->m_num_threads));
+        std::size_t started = 0;
+        try {
+            for (; started < this->m_num_threads; ++started) {
+                this->start_thread(started, [this, started, &ready] {
+                    this->warm_up(started);
+                    ready.count_down();
+                });
+            }
+        }
+        catch (...) {
+            // The workers already started still count the latch down: wait for them before it goes away
+            ready.count_down(static_cast<std::ptrdiff_t>(this->m_num_threads - started));
+            ready.wait();
+            throw;
+        }
+
+        this->m_started_threads = this->m_num_threads;
+        ready.wait();
     }
 }
 
 thread_pool_private::~thread_pool_private()
 {
+    {
+        // Workers cancel whatever is still queued, outside the lock and in parallel, and then exit
+        const std::scoped_lock<queue_mutex> lock(this->m_mutex);
+        this->m_state = state::canceling;
+        this->stop_running_tasks();
+        this->m_cv.notify_all();
+        this->m_spare_cv.notify_all();
+    }
+
     for (auto& thread : this->m_threads) {
-        thread.request_stop();
+        thread.join();
     }
 
-    const std::scoped_lock<std::mutex> lock(this->m_mutex);
-    for (const auto& item : this->m_work_queue) {
-        item->stop_source.request_stop();
-        item->after_work(true);
+    if (this->m_runtime) {
+        // Runners cancel the queued tasks just like workers do; they hold a raw pointer to the pool
+        unique_lock lock(this->m_mutex);
+        this->m_drained_cv.wait(lock, [this] { return this->m_runners == 0; });
     }
 
-    // GNU libstdc++ declares `std::stop_source.request_stop()` as `const`
-    // According to https://en.cppreference.com/w/cpp/thread/stop_source/request_stop,
-    // it is not `const`.
-    for (auto& stop_source : this->m_stop_sources) {
-        stop_source.request_stop();
+    for (const auto& item : this->m_work_queue) {
+        if (this->claim(*item)) {
+            item->stop();
+            item->after_work(true);
+            this->release(*item, thread_pool::task_status::canceled);
+        }
     }
 
     this->m_work_queue.clear();
-    this->m_cv.notify_all();
+    this->m_queue_length = 0;
 }
 
 thread_pool::task_t
 thread_pool_private::submit(const thread_pool::worker_t& worker, const thread_pool::after_work_t& after_work)
 {
-    this->m_tasks_queued.fetch_add(1U, std::memory_order_relaxed);
-    const std::scoped_lock<std::mutex> lock(this->m_mutex);
-    const auto& item = this->m_work_queue.emplace_back(
-        std::make_shared<work_item>(worker, after_work ? after_work : default_after_work)
-    );
-    this->m_cv.notify_one();
-    return item;
+    const std::scoped_lock<queue_mutex> lock(this->m_mutex);
+    this->ensure_accepting();
+    this->start_thread_if_needed();
+    return this->enqueue(std::make_shared<work_item>(worker, after_work ? after_work : default_after_work));
+}
+
+thread_pool::task_handle
+thread_pool_private::post(const thread_pool::worker_t& worker, const thread_pool::after_work_t& after_work)
+{
+    const std::scoped_lock<queue_mutex> lock(this->m_mutex);
+    this->ensure_accepting();
+    this->start_thread_if_needed();
+
+    auto item         = std::make_shared<work_item>(worker, after_work ? after_work : default_after_work);
+    const auto handle = this->m_handles.acquire(item.get());
+    item->handle      = handle.index;
+    this->enqueue(std::move(item));
+    return handle;
 }
 
 bool thread_pool_private::cancel(const thread_pool::task_t& task)
@@ -85,28 +188,137 @@ bool thread_pool_private::cancel(const thread_pool::task_t& task)
 
     auto predicate = [&sp_task](const std::shared_ptr<work_item>& item) { return item == sp_task; };
 
-    const std::scoped_lock<std::mutex> lock(this->m_mutex);
+    const std::scoped_lock<queue_mutex> lock(this->m_mutex);
     if (auto it = std::ranges::find_if(this->m_work_queue, predicate); it != this->m_work_queue.end()) {
+        WWA_TRACE(this, cancel, it->get());
         this->m_work_queue.erase(it);
+        this->m_queue_length.fetch_sub(1U, std::memory_order_relaxed);
         this->m_tasks_canceled.fetch_add(1U, std::memory_order_relaxed);
         return true;
     }
 
+    for (std::size_t i = 0; this->m_buffers && i < this->num_slots(); ++i) {
+        auto& buffer = this->m_buffers[i];
+        const std::scoped_lock<std::mutex> buffer_lock(buffer.mutex);
+        if (auto it = std::ranges::find_if(buffer.items, predicate); it != buffer.items.end()) {
+            WWA_TRACE(this, cancel, it->get());
+            buffer.items.erase(it);
+            this->m_buffered.fetch_sub(1U);
+            this->m_queue_length.fetch_sub(1U, std::memory_order_relaxed);
+            this->m_tasks_canceled.fetch_add(1U, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
     return false;
 }
 
+bool thread_pool_private::cancel(thread_pool::task_handle handle)
+{
+    if (!this->m_handles.cancel(handle)) {
+        return false;
+    }
+
+    this->m_tasks_canceled.fetch_add(1U, std::memory_order_relaxed);
+    return true;
+}
+
+thread_pool::task_status thread_pool_private::status(thread_pool::task_handle handle) const noexcept
+{
+    return this->m_handles.status(handle);
+}
+
+void thread_pool_private::shutdown()
+{
+    unique_lock lock(this->m_mutex);
+    if (this->m_state == state::running) {
+        this->m_state = state::draining;
+    }
+
+    this->m_drained_cv.wait(lock, [this] { return this->queue_drained(); });
+    if (this->m_state == state::draining) {
+        this->m_state = state::stopped;
+    }
+
+    this->m_cv.notify_all();
+    this->m_spare_cv.notify_all();
+}
+
+std::vector<thread_pool::pending_task> thread_pool_private::shutdown_now()
+{
+    std::list<std::shared_ptr<work_item>> queue;
+
+    {
+        const std::scoped_lock<queue_mutex> lock(this->m_mutex);
+        if (this->m_state != state::canceling) {
+            this->m_state = state::stopped;
+        }
+
+        queue.swap(this->m_work_queue);
+        std::size_t buffered = 0;
+        for (std::size_t i = 0; this->m_buffers && i < this->num_slots(); ++i) {
+            auto& buffer = this->m_buffers[i];
+            const std::scoped_lock<std::mutex> buffer_lock(buffer.mutex);
+            buffered += buffer.items.size();
+            std::ranges::move(buffer.items, std::back_inserter(queue));
+            buffer.items.clear();
+        }
+
+        // A worker may have popped a buffered task without having uncounted it yet: only subtract what was moved
+        this->m_buffered.fetch_sub(buffered);
+        this->m_queue_length.fetch_sub(queue.size(), std::memory_order_relaxed);
+        this->stop_running_tasks();
+        this->m_cv.notify_all();
+        this->m_spare_cv.notify_all();
+        if (this->queue_drained()) {
+            this->m_drained_cv.notify_all();
+        }
+    }
+
+    std::vector<thread_pool::pending_task> result;
+    result.reserve(queue.size());
+    for (auto& item : queue) {
+        if (this->claim(*item)) {
+            this->release(*item, thread_pool::task_status::canceled);
+            result.push_back({std::move(item->worker), std::move(item->after_work)});
+        }
+    }
+
+    return result;
+}
+
+bool thread_pool_private::shutdown_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time)
+{
+    unique_lock lock(this->m_mutex);
+    if (this->m_state == state::running) {
+        this->m_state = state::draining;
+    }
+
+    const bool drained = this->m_drained_cv.wait_until(lock, abs_time, [this] { return this->queue_drained(); });
+
+    if (this->m_state == state::draining) {
+        this->m_state = drained ? state::stopped : state::canceling;
+    }
+
+    if (!drained) {
+        this->stop_running_tasks();
+    }
+
+    this->m_cv.notify_all();
+    this->m_spare_cv.notify_all();
+    return drained;
+}
+
 void thread_pool_private::wait()
 {
     unique_lock lock(this->m_mutex);
-    this->m_drained_cv.wait(lock, [this] { return this->m_work_queue.empty() && this->m_active_threads == 0; });
+    this->m_drained_cv.wait(lock, [this] { return this->queue_drained(); });
 }
 
 bool thread_pool_private::wait_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time)
 {
     unique_lock lock(this->m_mutex);
-    return this->m_drained_cv.wait_until(lock, abs_time, [this] {
-        return this->m_work_queue.empty() && this->m_active_threads == 0;
-    });
+    return this->m_drained_cv.wait_until(lock, abs_time, [this] { return this->queue_drained(); });
 }
 
 std::size_t thread_pool_private::num_threads() const noexcept
@@ -124,10 +336,15 @@ std::size_t thread_pool_private::max_active_threads() const noexcept
     return this->m_max_active_threads;
 }
 
+std::size_t thread_pool_private::blocked_threads() const noexcept
+{
+    return this->m_blocked_threads;
+}
+
 std::size_t thread_pool_private::work_queue_size() const
 {
-    const std::scoped_lock<std::mutex> lock(this->m_mutex);
-    return this->m_work_queue.size();
+    const std::scoped_lock<queue_mutex> lock(this->m_mutex);
+    return this->m_work_queue.size() + this->m_buffered;
 }
 
 std::size_t thread_pool_private::tasks_queued() const noexcept
@@ -150,51 +367,648 @@ std::size_t thread_pool_private::tasks_canceled() const noexcept
     return this->m_tasks_canceled;
 }
 
+std::size_t thread_pool_private::arena_overflows() const noexcept
+{
+    return this->m_arena_overflows.load(std::memory_order_relaxed);
+}
+
+void thread_pool_private::set_error_handler(const thread_pool::error_handler_t& handler)
+{
+    auto ptr = handler ? std::make_shared<const thread_pool::error_handler_t>(handler) : nullptr;
+    const std::scoped_lock<std::mutex> lock(this->m_error_mutex);
+    this->m_error_handler = std::move(ptr);
+}
+
+std::vector<thread_pool::failure_record> thread_pool_private::recent_failures() const
+{
+    return this->m_failures.snapshot();
+}
+
+thread_pool::load_stats thread_pool_private::load() const
+{
+    const std::scoped_lock<std::mutex> lock(this->m_load_mutex);
+    const auto sample = this->take_load_sample();
+    const auto dt     = sample.timestamp - this->m_load_sample.timestamp;
+
+    if (dt > 0) {
+        const auto& prev    = this->m_load_sample;
+        const auto seconds  = static_cast<double>(dt) / 1e9;
+        const auto window   = std::chrono::duration<double>(this->m_load_window).count();
+        const auto alpha    = 1.0 - std::exp(-seconds / window);
+        const auto busy     = static_cast<double>(sample.busy_ns - prev.busy_ns);
+        const auto capacity = static_cast<double>(dt) * static_cast<double>(this->m_num_threads);
+
+        auto ewma = [alpha](double& avg, double value) { avg += alpha * (value - avg); };
+
+        ewma(this->m_load.utilization, std::clamp(busy / capacity, 0.0, 1.0));
+        ewma(this->m_load.completion_rate, static_cast<double>(sample.completed - prev.completed) / seconds);
+        ewma(this->m_load.arrival_rate, static_cast<double>(sample.arrived - prev.arrived) / seconds);
+        ewma(
+            this->m_load.queue_growth_rate,
+            (static_cast<double>(sample.queued) - static_cast<double>(prev.queued)) / seconds
+        );
+
+        this->m_load_sample = sample;
+    }
+
+    this->m_load.queue_length = sample.queued;
+    return this->m_load;
+}
+
+void thread_pool_private::set_load_window(std::chrono::steady_clock::duration window)
+{
+    const std::scoped_lock<std::mutex> lock(this->m_load_mutex);
+    this->m_load_window = window;
+}
+
+void thread_pool_private::enable_tracing([[maybe_unused]] bool enable)
+{
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_TRACING
+    this->m_tracer.enable(enable);
+#endif
+}
+
+bool thread_pool_private::tracing_enabled() const noexcept
+{
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_TRACING
+    return this->m_tracer.enabled();
+#else
+    return false;
+#endif
+}
+
+void thread_pool_private::dump_trace(std::ostream& os) const
+{
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_TRACING
+    this->m_tracer.dump(os);
+#else
+    os << R"({"displayTimeUnit":"ns","traceEvents":[]})";
+#endif
+}
+
+thread_pool::contention_stats thread_pool_private::contention() const noexcept
+{
+    thread_pool::contention_stats stats;
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_PROFILING
+    stats.lock_acquisitions      = this->m_mutex.acquisitions();
+    stats.contended_acquisitions = this->m_mutex.contended();
+    stats.lock_wait_time         = std::chrono::nanoseconds(this->m_mutex.wait_ns());
+    stats.lock_hold_time         = std::chrono::nanoseconds(this->m_mutex.hold_ns());
+    stats.wakeups                = this->m_contention.wakeups.load(std::memory_order_relaxed);
+    stats.spurious_wakeups       = this->m_contention.spurious_wakeups.load(std::memory_order_relaxed);
+    stats.notifications          = this->m_contention.notifications.load(std::memory_order_relaxed);
+    stats.submissions            = this->m_tasks_queued.load(std::memory_order_relaxed);
+#endif
+    return stats;
+}
+
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_TRACING
+void thread_pool_private::trace(trace_event type, const work_item* item) noexcept
+{
+    if (this->m_tracer.enabled()) [[unlikely]] {
+        const auto worker = (current_pool == this) ? current_worker : this->num_slots();
+        this->m_tracer.record(worker, type, reinterpret_cast<std::uintptr_t>(item));
+    }
+}
+#endif
+
+std::shared_ptr<thread_pool_private> thread_pool_private::shared_runtime()
+{
+    // The runtime lives for as long as some pool uses it
+    static std::mutex mutex;
+    static std::weak_ptr<thread_pool_private> instance;
+
+    const std::scoped_lock<std::mutex> lock(mutex);
+    auto runtime = instance.lock();
+    if (!runtime) {
+        runtime  = std::make_shared<thread_pool_private>(thread_pool::options{});
+        instance = runtime;
+    }
+
+    return runtime;
+}
+
 void thread_pool_private::worker_thread(
     const std::stop_token& stop_token, thread_pool_private* pool, std::size_t thread_index
 )
 {
-    while (!stop_token.stop_requested()) {
-        unique_lock lock(pool->m_mutex);
-        pool->m_cv.wait(lock, stop_token, [&pool] { return !pool->m_work_queue.empty(); });
+    current_pool   = pool;
+    current_worker = thread_index;
+
+    const bool spare = thread_index >= pool->m_num_threads;
+    auto& cv         = spare ? pool->m_spare_cv : pool->m_cv;
+    unique_lock lock(pool->m_mutex);
+    while (true) {
+        // Idle workers are how `submit()` decides whether to start another one
+        pool->m_idle_threads += spare ? 0U : 1U;
+        bool waited = false;
+        cv.wait(lock, stop_token, [pool, thread_index, &waited] {
+            const bool ready = (pool->has_work() && pool->may_run(thread_index)) || pool->stopping();
+            if (std::exchange(waited, true)) {
+                WWA_PROFILE(pool, wakeups);
+                if (!ready) {
+                    WWA_PROFILE(pool, spurious_wakeups);
+                }
+            }
 
-        if (!stop_token.stop_requested()) {
-            auto task = std::move(pool->m_work_queue.front());
-            pool->m_work_queue.pop_front();
+            return ready;
+        });
+        pool->m_idle_threads -= spare ? 0U : 1U;
 
-            if (!task->stop_source.stop_requested()) {
-                pool->m_stop_sources[thread_index] = task->stop_source;
-                lock.unlock();
-                pool->run_task(task);
-                lock.lock();
-            }
-            else {
-                pool->m_tasks_canceled.fetch_add(1U, std::memory_order_relaxed);
+        if (!pool->has_work() || !pool->may_run(thread_index)) {
+            if (pool->stopping() || stop_token.stop_requested()) {
+                break;
             }
 
-            if (pool->m_work_queue.empty() && pool->m_active_threads == 0) {
-                pool->m_drained_cv.notify_all();
+            continue;
+        }
+
+        if (pool->m_buffers) {
+            pool->run_batch(lock, thread_index);
+        }
+        else {
+            pool->run_next(lock, thread_index);
+        }
+    }
+}
+
+void thread_pool_private::start_thread(std::size_t thread_index, const std::function<void()>& on_start)
+{
+    auto attrs = this->m_thread_attrs;
+    if (!attrs.name.empty()) {
+        attrs.name += '-' + std::to_string(thread_index);
+    }
+
+    this->m_threads.emplace_back(attrs, [this, thread_index, on_start](const std::stop_token& token) {
+        if (on_start) {
+            on_start();
+        }
+
+        worker_thread(token, this, thread_index);
+    });
+}
+
+void thread_pool_private::start_thread_if_needed()
+{
+    // Called with `m_mutex` held, before the new task is queued: every queued task should have a worker
+    if (!this->m_runtime && this->m_started_threads < this->m_num_threads &&
+        this->m_work_queue.size() >= this->m_idle_threads) {
+        try {
+            this->start_thread(this->m_started_threads);
+            ++this->m_started_threads;
+        }
+        catch (...) {
+            // The workers already running will get to the task; the next submission tries again
+            if (this->m_started_threads == 0) {
+                throw;
             }
         }
     }
 }
 
-void thread_pool_private::run_task(const std::shared_ptr<work_item>& task)
+void thread_pool_private::warm_up(std::size_t thread_index)
+{
+    os_thread::prefault_stack();
+    if (!this->m_arenas.empty()) {
+        current_pool   = this;
+        current_worker = thread_index;
+        current_arena();
+        if (const auto& arena = this->m_arenas[thread_index]) {
+            arena->prefault();
+        }
+    }
+}
+
+void thread_pool_private::run_next(unique_lock& lock, std::size_t thread_index)
 {
+    auto task = std::move(this->m_work_queue.front());
+    this->m_work_queue.pop_front();
+    this->m_queue_length.fetch_sub(1U, std::memory_order_relaxed);
+    WWA_TRACE(this, dequeue, task.get());
+
     auto n = this->m_active_threads.fetch_add(1U, std::memory_order_relaxed) + 1U;
     atomic_fetch_max(this->m_max_active_threads, n);
 
+    if (!this->claim(*task)) {
+        // Canceled through its handle; already counted
+        WWA_TRACE(this, cancel, task.get());
+    }
+    else if (this->m_state == state::canceling) {
+        lock.unlock();
+        WWA_TRACE(this, cancel, task.get());
+        task->stop();
+        task->after_work(true);
+        this->m_tasks_canceled.fetch_add(1U, std::memory_order_relaxed);
+        this->release(*task, thread_pool::task_status::canceled);
+        lock.lock();
+    }
+    else if (!task->stop_source.stop_requested()) {
+        this->m_stop_sources[thread_index] = task->stop_source;
+        lock.unlock();
+        this->run_task(task, thread_index);
+        this->release(*task, thread_pool::task_status::done);
+        lock.lock();
+    }
+    else {
+        WWA_TRACE(this, cancel, task.get());
+        this->m_tasks_canceled.fetch_add(1U, std::memory_order_relaxed);
+        this->release(*task, thread_pool::task_status::canceled);
+    }
+
+    this->m_active_threads.fetch_sub(1U, std::memory_order_relaxed);
+    if (this->queue_drained()) {
+        this->m_drained_cv.notify_all();
+    }
+}
+
+void thread_pool_private::run_batch(unique_lock& lock, std::size_t thread_index)
+{
+    if (!this->m_work_queue.empty()) {
+        // Batch only when there is a backlog for every worker, so that short queues keep their latency
+        const auto size   = this->m_work_queue.size() / this->m_num_threads;
+        const auto n      = std::clamp(size, std::size_t{1}, this->m_max_batch);
+        auto& buffer      = this->m_buffers[thread_index];
+        const auto middle = std::next(this->m_work_queue.begin(), static_cast<std::ptrdiff_t>(n));
+
+        {
+            const std::scoped_lock<std::mutex> buffer_lock(buffer.mutex);
+            std::move(this->m_work_queue.begin(), middle, std::back_inserter(buffer.items));
+        }
+
+        this->m_work_queue.erase(this->m_work_queue.begin(), middle);
+        this->m_buffered.fetch_add(n);
+        if (n > 1) {
+            // Let an idle worker take some of the batch
+            this->m_cv.notify_one();
+            WWA_PROFILE(this, notifications);
+        }
+    }
+
+    lock.unlock();
+    while (const auto task = this->take_buffered(thread_index)) {
+        this->run_buffered(task, thread_index);
+    }
+
+    lock.lock();
+}
+
+std::shared_ptr<work_item> thread_pool_private::take_buffered(std::size_t thread_index)
+{
+    // The worker counts as active before the task leaves the buffer, so that the pool never looks drained in between
+    this->m_active_threads.fetch_add(1U);
+    auto task = this->pop_buffered(thread_index);
+    if (!task) {
+        this->buffered_task_done();
+        return task;
+    }
+
+    atomic_fetch_max(this->m_max_active_threads, this->m_active_threads.load(std::memory_order_relaxed));
+    this->m_buffered.fetch_sub(1U);
+    this->m_queue_length.fetch_sub(1U, std::memory_order_relaxed);
+    WWA_TRACE(this, dequeue, task.get());
+    return task;
+}
+
+std::shared_ptr<work_item> thread_pool_private::pop_buffered(std::size_t thread_index)
+{
+    std::shared_ptr<work_item> task;
+
+    {
+        auto& buffer = this->m_buffers[thread_index];
+        const std::scoped_lock<std::mutex> buffer_lock(buffer.mutex);
+        if (!buffer.items.empty()) {
+            task = std::move(buffer.items.front());
+            buffer.items.pop_front();
+            return task;
+        }
+    }
+
+    // Steal the newest unstarted task of another worker; the owner keeps working from the oldest end
+    for (std::size_t i = 1; i < this->num_slots(); ++i) {
+        auto& victim = this->m_buffers[(thread_index + i) % this->num_slots()];
+        const std::scoped_lock<std::mutex> buffer_lock(victim.mutex);
+        if (!victim.items.empty()) {
+            task = std::move(victim.items.back());
+            victim.items.pop_back();
+            WWA_TRACE(this, steal, task.get());
+            break;
+        }
+    }
+
+    return task;
+}
+
+void thread_pool_private::run_buffered(const std::shared_ptr<work_item>& task, std::size_t thread_index)
+{
+    if (!this->claim(*task)) {
+        WWA_TRACE(this, cancel, task.get());
+    }
+    else if (this->m_state == state::canceling) {
+        WWA_TRACE(this, cancel, task.get());
+        task->stop();
+        task->after_work(true);
+        this->m_tasks_canceled.fetch_add(1U, std::memory_order_relaxed);
+        this->release(*task, thread_pool::task_status::canceled);
+    }
+    else if (!task->stop_source.stop_requested()) {
+        {
+            const std::scoped_lock<std::mutex> buffer_lock(this->m_buffers[thread_index].mutex);
+            this->m_stop_sources[thread_index] = task->stop_source;
+        }
+
+        this->run_task(task, thread_index);
+        this->release(*task, thread_pool::task_status::done);
+    }
+    else {
+        WWA_TRACE(this, cancel, task.get());
+        this->m_tasks_canceled.fetch_add(1U, std::memory_order_relaxed);
+        this->release(*task, thread_pool::task_status::canceled);
+    }
+
+    this->buffered_task_done();
+}
+
+void thread_pool_private::buffered_task_done()
+{
+    // Only take the lock when this may have been the last task: `m_queue_length` counts queued and buffered tasks
+    if (this->m_active_threads.fetch_sub(1U) == 1U && this->m_queue_length.load(std::memory_order_relaxed) == 0) {
+        const std::scoped_lock<queue_mutex> lock(this->m_mutex);
+        this->m_drained_cv.notify_all();
+    }
+}
+
+void thread_pool_private::start_runner()
+{
+    // Called with `m_mutex` held. Every runner that has not started yet will take one queued task
+    const auto pending = this->m_runners - this->m_active_threads.load(std::memory_order_relaxed);
+    const auto limit   = this->m_num_threads + std::min(this->m_blocked_threads.load(), this->m_max_spares);
+    if (this->m_runners < limit && pending < this->m_work_queue.size()) {
+        this->m_runtime->submit([this](const std::stop_token&) { this->runner(); });
+        ++this->m_runners;
+    }
+}
+
+void thread_pool_private::runner()
+{
+    auto* const prev_pool  = std::exchange(current_pool, this);
+    const auto prev_worker = current_worker;
+
+    unique_lock lock(this->m_mutex);
+    const auto slot = this->m_free_slots.back();
+    this->m_free_slots.pop_back();
+    current_worker = slot;
+
+    // Keep going while nobody else is waiting for the runtime; otherwise requeue behind them
+    bool requeue = false;
+    while (!this->m_work_queue.empty()) {
+        this->run_next(lock, slot);
+        if (this->m_runtime->m_queue_length.load(std::memory_order_relaxed) != 0) {
+            requeue = !this->m_work_queue.empty();
+            break;
+        }
+    }
+
+    this->m_free_slots.push_back(slot);
+    current_pool   = prev_pool;
+    current_worker = prev_worker;
+
+    if (requeue) {
+        this->m_runtime->submit([this](const std::stop_token&) { this->runner(); });
+    }
+    else if (--this->m_runners == 0) {
+        this->m_drained_cv.notify_all();
+    }
+}
+
+void thread_pool_private::ensure_accepting() const
+{
+    // Called with `m_mutex` held
+    if (this->m_state != state::running && (this->m_state != state::draining || current_pool != this)) {
+        throw std::runtime_error("thread pool is shut down");
+    }
+}
+
+const std::shared_ptr<work_item>& thread_pool_private::enqueue(std::shared_ptr<work_item>&& item)
+{
+    // Called with `m_mutex` held
+    this->m_tasks_queued.fetch_add(1U, std::memory_order_relaxed);
+    const auto& queued = this->m_work_queue.emplace_back(std::move(item));
+    this->m_queue_length.fetch_add(1U, std::memory_order_relaxed);
+    WWA_TRACE(this, submit, queued.get());
+    if (this->m_runtime) {
+        this->start_runner();
+    }
+    else {
+        this->m_cv.notify_one();
+        WWA_PROFILE(this, notifications);
+        if (this->m_blocked_threads != 0) {
+            this->m_spare_cv.notify_all();
+            WWA_PROFILE(this, notifications);
+        }
+    }
+
+    return queued;
+}
+
+bool thread_pool_private::claim(const work_item& item)
+{
+    return item.handle == handle_table::no_slot || this->m_handles.start(item.handle);
+}
+
+void thread_pool_private::release(const work_item& item, thread_pool::task_status status)
+{
+    if (item.handle != handle_table::no_slot) {
+        this->m_handles.finish(item.handle, status);
+    }
+}
+
+void thread_pool_private::run_task(const std::shared_ptr<work_item>& task, std::size_t thread_index)
+{
+    auto& state = this->m_worker_states[thread_index];
+    auto start  = now_ns();
+    state.busy_since.store(start, std::memory_order_release);
+    WWA_TRACE(this, start, task.get());
+
     try {
         task->worker(task->stop_source.get_token());
         task->after_work(false);
         this->m_tasks_completed.fetch_add(1U, std::memory_order_relaxed);
     }
-    catch (const std::exception&) {
+    catch (...) {
+        this->task_failed(std::current_exception());
         task->after_work(false);
         this->m_tasks_failed.fetch_add(1U, std::memory_order_relaxed);
     }
 
-    this->m_active_threads.fetch_sub(1U, std::memory_order_relaxed);
+    WWA_TRACE(this, finish, task.get());
+
+    state.busy_ns.fetch_add(now_ns() - start, std::memory_order_relaxed);
+    state.busy_since.store(0, std::memory_order_release);
+
+    this->reset_current_arena();
+}
+
+void thread_pool_private::task_failed(const std::exception_ptr& exception)
+{
+    this->m_failures.record(exception);
+
+    std::shared_ptr<const thread_pool::error_handler_t> handler;
+    {
+        const std::scoped_lock<std::mutex> lock(this->m_error_mutex);
+        handler = this->m_error_handler;
+    }
+
+    if (handler) {
+        (*handler)(exception);
+    }
+}
+
+thread_pool_private* thread_pool_private::begin_blocking()
+{
+    auto* pool = current_pool;
+    if (pool == nullptr) {
+        return nullptr;
+    }
+
+    pool->m_blocked_threads.fetch_add(1U, std::memory_order_relaxed);
+    try {
+        if (pool->m_runtime) {
+            // The worker being blocked belongs to the runtime; the pool may also need another runner
+            pool->m_runtime->m_blocked_threads.fetch_add(1U, std::memory_order_relaxed);
+            pool->m_runtime->compensate();
+
+            const std::scoped_lock<queue_mutex> lock(pool->m_mutex);
+            pool->start_runner();
+        }
+        else {
+            pool->compensate();
+        }
+    }
+    catch (...) {  // NOLINT(bugprone-empty-catch)
+        // Could not start a spare worker or runner; block without one
+    }
+
+    return pool;
+}
+
+void thread_pool_private::end_blocking()
+{
+    // Spares notice that they are no longer needed once they finish their current task
+    if (this->m_runtime) {
+        this->m_runtime->m_blocked_threads.fetch_sub(1U, std::memory_order_relaxed);
+    }
+
+    this->m_blocked_threads.fetch_sub(1U, std::memory_order_relaxed);
+}
+
+std::pmr::memory_resource* thread_pool_private::current_arena() noexcept
+{
+    auto* pool = current_pool;
+    if (pool == nullptr || pool->m_arenas.empty()) {
+        return std::pmr::get_default_resource();
+    }
+
+    // The slot belongs to this thread until the task returns
+    auto& arena = pool->m_arenas[current_worker];
+    if (!arena) {
+        try {
+            arena = std::make_unique<worker_arena>(
+                pool->m_arena_size, pool->m_arena_huge_pages, &pool->m_arena_overflows
+            );
+        }
+        catch (const std::bad_alloc&) {
+            return std::pmr::get_default_resource();
+        }
+    }
+
+    return arena.get();
+}
+
+void thread_pool_private::reset_current_arena() noexcept
+{
+    // Also called between the tasks that strands and task graphs run one after another within a single pool task
+    auto* pool = current_pool;
+    if (pool != nullptr && !pool->m_arenas.empty() && pool->m_arenas[current_worker]) {
+        pool->m_arenas[current_worker]->reset();
+    }
+}
+
+void thread_pool_private::compensate()
+{
+    const std::scoped_lock<queue_mutex> lock(this->m_mutex);
+    const auto spares = this->m_started_spares;
+    if (spares < this->m_max_spares && spares < this->m_blocked_threads && !this->stopping()) {
+        this->start_thread(this->m_num_threads + spares);
+        ++this->m_started_spares;
+    }
+
+    this->m_spare_cv.notify_all();
+    WWA_PROFILE(this, notifications);
+}
+
+bool thread_pool_private::stopping() const noexcept
+{
+    return this->m_state == state::canceling || this->m_state == state::stopped;
+}
+
+bool thread_pool_private::has_work() const noexcept
+{
+    return !this->m_work_queue.empty() || this->m_buffered != 0;
+}
+
+bool thread_pool_private::queue_drained() const noexcept
+{
+    return this->m_work_queue.empty() && this->m_buffered == 0 && this->m_active_threads == 0;
+}
+
+bool thread_pool_private::may_run(std::size_t thread_index) const noexcept
+{
+    // Spare number `i` only works while more than `i` workers are blocked
+    return thread_index < this->m_num_threads + this->m_blocked_threads.load(std::memory_order_relaxed);
+}
+
+std::size_t thread_pool_private::num_slots() const noexcept
+{
+    return this->m_num_threads + this->m_max_spares;
+}
+
+void thread_pool_private::stop_running_tasks()
+{
+    // GNU libstdc++ declares `std::stop_source.request_stop()` as `const`
+    // According to https://en.cppreference.com/w/cpp/thread/stop_source/request_stop,
+    // it is not `const`.
+    // Batching workers publish their stop source under their buffer's lock instead of `m_mutex`
+    for (std::size_t i = 0; i < this->m_stop_sources.size(); ++i) {
+        if (this->m_buffers) {
+            const std::scoped_lock<std::mutex> buffer_lock(this->m_buffers[i].mutex);
+            this->m_stop_sources[i].request_stop();
+        }
+        else {
+            this->m_stop_sources[i].request_stop();
+        }
+    }
+}
+
+thread_pool_private::load_sample thread_pool_private::take_load_sample() const noexcept
+{
+    load_sample sample;
+    sample.timestamp = now_ns();
+    sample.completed = this->m_tasks_completed.load(std::memory_order_relaxed) +
+                       this->m_tasks_failed.load(std::memory_order_relaxed) +
+                       this->m_tasks_canceled.load(std::memory_order_relaxed);
+    sample.arrived   = this->m_tasks_queued.load(std::memory_order_relaxed);
+    sample.queued    = this->m_queue_length.load(std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < this->num_slots(); ++i) {
+        const auto& state = this->m_worker_states[i];
+        const auto since  = state.busy_since.load(std::memory_order_acquire);
+        sample.busy_ns += state.busy_ns.load(std::memory_order_relaxed);
+        if (since != 0) {
+            sample.busy_ns += sample.timestamp - since;
+        }
+    }
+
+    return sample;
 }
 
 }  // namespace wwa
@@ -5,20 +5,45 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iosfwd>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <stop_token>
-#include <thread>
 #include <vector>
 
+#include "failure_log_p.h"
+#include "handle_table_p.h"
+#include "os_thread_p.h"
 #include "threadpool.h"
+#include "worker_arena_p.h"
+
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_TRACING
+#    include "trace_p.h"
+#endif
+
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_PROFILING
+#    include "contention_p.h"
+#endif
 
 namespace wwa {
 
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_PROFILING
+using queue_mutex = profiled_mutex;
+using queue_cv    = std::condition_variable_any;
+#else
+using queue_mutex = std::mutex;
+using queue_cv    = std::condition_variable;
+#endif
+
 class thread_pool_private {
 public:
-    explicit thread_pool_private(std::size_t n);
+    explicit thread_pool_private(const thread_pool::options& opts);
     ~thread_pool_private();
 
     thread_pool_private(const thread_pool_private&)                = delete;
@@ -30,36 +55,152 @@ public:
     submit(const thread_pool::worker_t& worker, const thread_pool::after_work_t& after_work = nullptr);
 
     bool cancel(const thread_pool::task_t& task);
+    thread_pool::task_handle
+    post(const thread_pool::worker_t& worker, const thread_pool::after_work_t& after_work = nullptr);
+    bool cancel(thread_pool::task_handle handle);
+    thread_pool::task_status status(thread_pool::task_handle handle) const noexcept;
+    void shutdown();
+    std::vector<thread_pool::pending_task> shutdown_now();
+    bool shutdown_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time);
     void wait();
     bool wait_until(const std::chrono::time_point<std::chrono::steady_clock>& abs_time);
 
     std::size_t num_threads() const noexcept;
     std::size_t active_threads() const noexcept;
     std::size_t max_active_threads() const noexcept;
+    std::size_t blocked_threads() const noexcept;
     std::size_t work_queue_size() const;
     std::size_t tasks_queued() const noexcept;
     std::size_t tasks_completed() const noexcept;
     std::size_t tasks_failed() const noexcept;
     std::size_t tasks_canceled() const noexcept;
+    std::size_t arena_overflows() const noexcept;
+
+    void enable_tracing(bool enable);
+    bool tracing_enabled() const noexcept;
+    void dump_trace(std::ostream& os) const;
+    thread_pool::contention_stats contention() const noexcept;
+
+    void set_error_handler(const thread_pool::error_handler_t& handler);
+    std::vector<thread_pool::failure_record> recent_failures() const;
+
+    thread_pool::load_stats load() const;
+    void set_load_window(std::chrono::steady_clock::duration window);
+
+    static thread_pool_private* begin_blocking();
+    void end_blocking();
+
+    static std::pmr::memory_resource* current_arena() noexcept;
+    static void reset_current_arena() noexcept;
 
 private:
+    // `draining`: only the pool's own workers may submit; `canceling`: queued tasks get canceled;
+    // workers exit once the queue is empty in the `canceling` and `stopped` states
+    enum class state : std::uint8_t { running, draining, canceling, stopped };
+
+    struct alignas(64) worker_state {
+        std::atomic<std::int64_t> busy_ns{0};
+        std::atomic<std::int64_t> busy_since{0};
+    };
+
+    // Tasks a worker has taken from the queue in a batch but not started yet
+    struct alignas(64) worker_buffer {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<work_item>> items;
+    };
+
+    struct load_sample {
+        std::int64_t timestamp = 0;
+        std::int64_t busy_ns   = 0;
+        std::size_t completed  = 0;
+        std::size_t arrived    = 0;
+        std::size_t queued     = 0;
+    };
+
+    // Set for pools running on the shared runtime: their "workers" are runner tasks submitted to it
+    std::shared_ptr<thread_pool_private> m_runtime;
+    std::size_t m_runners = 0;
+    std::vector<std::size_t> m_free_slots;
+
     std::size_t m_num_threads;
+    std::size_t m_max_spares;
+    std::size_t m_max_batch;
+    std::size_t m_started_threads = 0;
+    std::size_t m_started_spares  = 0;
+    std::size_t m_idle_threads    = 0;
+    thread_attributes m_thread_attrs;
+    std::atomic<std::size_t> m_blocked_threads{0};
     std::atomic<std::size_t> m_active_threads{0};
     std::atomic<std::size_t> m_max_active_threads{0};
     std::list<std::shared_ptr<work_item>> m_work_queue;
-    mutable std::mutex m_mutex;
+    handle_table m_handles;
+    std::atomic<state> m_state{state::running};
+    mutable queue_mutex m_mutex;
     std::condition_variable_any m_cv;
-    std::condition_variable m_drained_cv;
+    std::condition_variable_any m_spare_cv;
+    queue_cv m_drained_cv;
     std::vector<std::stop_source> m_stop_sources;
-    std::vector<std::jthread> m_threads;
+    std::unique_ptr<worker_state[]> m_worker_states;  // NOLINT(*-avoid-c-arrays)
+    std::unique_ptr<worker_buffer[]> m_buffers;       // NOLINT(*-avoid-c-arrays)
+    std::atomic<std::size_t> m_buffered{0};
+    std::size_t m_arena_size;
+    bool m_arena_huge_pages;
+    std::atomic<std::size_t> m_arena_overflows{0};
+    std::vector<std::unique_ptr<worker_arena>> m_arenas;  // created on first use
+    std::vector<os_thread> m_threads;
     std::atomic<std::size_t> m_tasks_queued{0};
     std::atomic<std::size_t> m_tasks_completed{0};
     std::atomic<std::size_t> m_tasks_failed{0};
     std::atomic<std::size_t> m_tasks_canceled{0};
+    std::atomic<std::size_t> m_queue_length{0};
+
+    failure_log m_failures;
+    std::shared_ptr<const thread_pool::error_handler_t> m_error_handler;
+    mutable std::mutex m_error_mutex;
 
+    mutable std::mutex m_load_mutex;
+    mutable load_sample m_load_sample;
+    mutable thread_pool::load_stats m_load;
+    std::chrono::steady_clock::duration m_load_window{std::chrono::seconds(1)};
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_PROFILING
+    contention_counters m_contention;
+#endif
+#ifdef WWA_SIMPLE_THREADPOOL_ENABLE_TRACING
+    tracer m_tracer;
+
+    void trace(trace_event type, const work_item* item) noexcept;
+#endif
+
+    static std::shared_ptr<thread_pool_private> shared_runtime();
     static void worker_thread(const std::stop_token& stop_token, thread_pool_private* pool, std::size_t thread_index);
 
-    void run_task(const std::shared_ptr<work_item>& task);
+    void start_thread(std::size_t thread_index, const std::function<void()>& on_start = nullptr);
+    void start_thread_if_needed();
+    void warm_up(std::size_t thread_index);
+
+    void run_next(std::unique_lock<queue_mutex>& lock, std::size_t thread_index);
+    void run_batch(std::unique_lock<queue_mutex>& lock, std::size_t thread_index);
+    std::shared_ptr<work_item> take_buffered(std::size_t thread_index);
+    std::shared_ptr<work_item> pop_buffered(std::size_t thread_index);
+    void run_buffered(const std::shared_ptr<work_item>& task, std::size_t thread_index);
+    void buffered_task_done();
+    void start_runner();
+    void compensate();
+    void runner();
+
+    void ensure_accepting() const;
+    const std::shared_ptr<work_item>& enqueue(std::shared_ptr<work_item>&& item);
+    bool claim(const work_item& item);
+    void release(const work_item& item, thread_pool::task_status status);
+    void run_task(const std::shared_ptr<work_item>& task, std::size_t thread_index);
+    void task_failed(const std::exception_ptr& exception);
+    bool stopping() const noexcept;
+    bool has_work() const noexcept;
+    bool queue_drained() const noexcept;
+    bool may_run(std::size_t thread_index) const noexcept;
+    std::size_t num_slots() const noexcept;
+    void stop_running_tasks();
+    load_sample take_load_sample() const noexcept;
 };
 
 struct work_item {
@@ -67,6 +208,7 @@ struct work_item {
     thread_pool::worker_t worker;
     thread_pool::after_work_t after_work;
     mutable std::stop_source stop_source;
+    std::uint32_t handle = handle_table::no_slot;  // slot in `thread_pool_private::m_handles` for `post()`ed tasks
     // NOLINTEND(misc-non-private-member-variables-in-classes)
 
     void stop() const { this->stop_source.request_stop(); }
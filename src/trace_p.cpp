@@ -0,0 +1,150 @@
+#include "trace_p.h"
+
+#include <algorithm>
+#include <ios>
+#include <ostream>
+#include <utility>
+
+namespace {
+
+const char* event_name(wwa::trace_event type)
+{
+    switch (type) {
+        case wwa::trace_event::submit:
+            return "submit";
+        case wwa::trace_event::dequeue:
+            return "dequeue";
+        case wwa::trace_event::steal:
+            return "steal";
+        case wwa::trace_event::start:
+        case wwa::trace_event::finish:
+            return "run";
+        case wwa::trace_event::cancel:
+            return "cancel";
+    }
+
+    return "unknown";
+}
+
+const char* event_phase(wwa::trace_event type)
+{
+    switch (type) {
+        case wwa::trace_event::start:
+            return "B";
+        case wwa::trace_event::finish:
+            return "E";
+        default:
+            return "i";
+    }
+}
+
+}  // namespace
+
+namespace wwa {
+
+trace_buffer::trace_buffer() : m_slots(std::make_unique<slot[]>(trace_buffer::capacity))  // NOLINT(*-avoid-c-arrays)
+{}
+
+void trace_buffer::record(trace_event type, std::uint64_t timestamp, std::uintptr_t task) noexcept
+{
+    const auto idx = this->m_head.fetch_add(1U, std::memory_order_relaxed);
+    auto& slot     = this->m_slots[idx % trace_buffer::capacity];
+
+    // A reader that sees any of the new values is guaranteed to also see the reset sequence number
+    slot.seq.store(0, std::memory_order_relaxed);
+    slot.timestamp.store(timestamp, std::memory_order_release);
+    slot.task.store(task, std::memory_order_release);
+    slot.type.store(type, std::memory_order_release);
+    slot.seq.store(idx + 1U, std::memory_order_release);
+}
+
+template<typename F>
+void trace_buffer::for_each(F&& f) const
+{
+    const auto head  = this->m_head.load(std::memory_order_acquire);
+    const auto first = head > trace_buffer::capacity ? head - trace_buffer::capacity : 0;
+
+    for (auto idx = first; idx < head; ++idx) {
+        const auto& slot = this->m_slots[idx % trace_buffer::capacity];
+        const auto seq   = slot.seq.load(std::memory_order_acquire);
+        if (seq != idx + 1U) {
+            continue;
+        }
+
+        const auto timestamp = slot.timestamp.load(std::memory_order_acquire);
+        const auto task      = slot.task.load(std::memory_order_acquire);
+        const auto type      = slot.type.load(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) == seq) {
+            f(type, timestamp, task);
+        }
+    }
+}
+
+tracer::tracer(std::size_t num_workers) : m_num_workers(num_workers), m_epoch(std::chrono::steady_clock::now()) {}
+
+void tracer::enable(bool enable)
+{
+    const std::scoped_lock<std::mutex> lock(this->m_mutex);
+    if (enable && this->m_buffers.empty()) {
+        this->m_buffers.reserve(this->m_num_workers + 1U);
+        for (std::size_t i = 0; i <= this->m_num_workers; ++i) {
+            this->m_buffers.push_back(std::make_unique<trace_buffer>());
+        }
+    }
+
+    this->m_enabled.store(enable, std::memory_order_release);
+}
+
+void tracer::record(std::size_t worker, trace_event type, std::uintptr_t task) noexcept
+{
+    const auto now = std::chrono::steady_clock::now() - this->m_epoch;
+    const auto ts  = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+    this->m_buffers[std::min(worker, this->m_num_workers)]->record(type, ts, task);
+}
+
+void tracer::dump(std::ostream& os) const
+{
+    const std::scoped_lock<std::mutex> lock(this->m_mutex);
+    const auto flags      = os.flags();
+    const char* separator = "";
+
+    os << R"({"displayTimeUnit":"ns","traceEvents":[)";
+    for (std::size_t tid = 0; tid < this->m_buffers.size(); ++tid) {
+        os << separator << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid << R"(,"args":{"name":")";
+        if (tid < this->m_num_workers) {
+            os << "worker " << tid;
+        }
+        else {
+            os << "external";
+        }
+
+        os << R"("}})";
+        separator = ",";
+
+        // The ring may have dropped the start of a task that is still in it; do not emit unmatched ends
+        bool running = false;
+        this->m_buffers[tid]->for_each([&os, &running, tid](trace_event type, std::uint64_t ts, std::uintptr_t task) {
+            if (type == trace_event::finish && !std::exchange(running, false)) {
+                return;
+            }
+
+            if (type == trace_event::start) {
+                running = true;
+            }
+
+            os << R"(,{"name":")" << event_name(type) << R"(","cat":"task","ph":")" << event_phase(type)
+               << R"(","pid":1,"tid":)" << tid << R"(,"ts":)" << std::dec << (ts / 1000U) << '.' << (ts % 1000U / 100U)
+               << (ts % 100U / 10U) << (ts % 10U);
+            if (type != trace_event::start && type != trace_event::finish) {
+                os << R"(,"s":"t")";
+            }
+
+            os << R"(,"args":{"task":"0x)" << std::hex << task << std::dec << R"("}})";
+        });
+    }
+
+    os << "]}";
+    os.flags(flags);
+}
+
+}  // namespace wwa
@@ -0,0 +1,64 @@
+#ifndef D83F4A27_6C1E_4B95_A0D2_5E9B7C3F1A48
+#define D83F4A27_6C1E_4B95_A0D2_5E9B7C3F1A48
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace wwa {
+
+enum class trace_event : std::uint8_t { submit, dequeue, steal, start, finish, cancel };
+
+// Fixed-size ring of trace events. Writers never block: the oldest events are overwritten when the ring is full.
+// Every slot is a small seqlock, so a concurrent reader skips the slots that are being written.
+class trace_buffer {
+public:
+    static constexpr std::size_t capacity = 4096;
+
+    trace_buffer();
+
+    void record(trace_event type, std::uint64_t timestamp, std::uintptr_t task) noexcept;
+
+    template<typename F>
+    void for_each(F&& f) const;
+
+private:
+    struct slot {
+        std::atomic<std::uint64_t> seq{0};
+        std::atomic<std::uint64_t> timestamp{0};
+        std::atomic<std::uintptr_t> task{0};
+        std::atomic<trace_event> type{trace_event::submit};
+    };
+
+    std::unique_ptr<slot[]> m_slots;  // NOLINT(*-avoid-c-arrays)
+    std::atomic<std::uint64_t> m_head{0};
+};
+
+// Keeps one ring per worker plus one shared by all other threads. The rings are only allocated
+// when tracing is enabled for the first time.
+class tracer {
+public:
+    explicit tracer(std::size_t num_workers);
+
+    [[nodiscard]] bool enabled() const noexcept { return this->m_enabled.load(std::memory_order_acquire); }
+    void enable(bool enable);
+
+    void record(std::size_t worker, trace_event type, std::uintptr_t task) noexcept;
+    void dump(std::ostream& os) const;
+
+private:
+    std::size_t m_num_workers;
+    std::atomic<bool> m_enabled{false};
+    std::vector<std::unique_ptr<trace_buffer>> m_buffers;
+    std::chrono::steady_clock::time_point m_epoch;
+    mutable std::mutex m_mutex;
+};
+
+}  // namespace wwa
+
+#endif /* D83F4A27_6C1E_4B95_A0D2_5E9B7C3F1A48 */
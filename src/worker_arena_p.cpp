@@ -0,0 +1,100 @@
+#include "worker_arena_p.h"
+
+#include <cstddef>
+#include <functional>
+#include <new>
+
+#ifdef __linux__
+#    include <sys/mman.h>
+#endif
+
+namespace {
+
+constexpr std::size_t buffer_alignment = 64;
+
+#ifdef __linux__
+constexpr std::size_t huge_page_size = std::size_t{2} << 20U;
+#endif
+
+}  // namespace
+
+namespace wwa {
+
+worker_arena::worker_arena(std::size_t size, bool huge_pages, std::atomic<std::size_t>* overflows)
+    : m_buffer(allocate(size, huge_pages)),
+      m_resource(this->m_buffer.data, this->m_buffer.size, std::pmr::get_default_resource()), m_overflows(overflows)
+{
+}
+
+worker_arena::~worker_arena()
+{
+    this->m_resource.release();
+#ifdef __linux__
+    if (this->m_buffer.mapped) {
+        munmap(this->m_buffer.data, this->m_buffer.size);
+        return;
+    }
+#endif
+
+    ::operator delete(this->m_buffer.data, std::align_val_t{buffer_alignment});
+}
+
+void worker_arena::prefault() noexcept
+{
+    constexpr std::size_t page = 4096;
+    auto* data                 = static_cast<volatile char*>(this->m_buffer.data);
+    for (std::size_t offset = 0; offset < this->m_buffer.size; offset += page) {
+        data[offset] = 0;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+}
+
+void* worker_arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    void* p          = this->m_resource.allocate(bytes, alignment);
+    const auto* data = static_cast<const std::byte*>(this->m_buffer.data);
+    const auto* ptr  = static_cast<const std::byte*>(p);
+    if (std::less<>()(ptr, data) || !std::less<>()(ptr, data + this->m_buffer.size)) {  // NOLINT(*-pointer-arithmetic)
+        this->m_overflows->fetch_add(1U, std::memory_order_relaxed);
+    }
+
+    return p;
+}
+
+void worker_arena::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    this->m_resource.deallocate(p, bytes, alignment);
+}
+
+bool worker_arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+worker_arena::buffer worker_arena::allocate(std::size_t size, bool huge_pages)
+{
+#ifdef __linux__
+    if (huge_pages) {
+        // Reserved huge pages if the system has any, transparent huge pages otherwise
+        const auto rounded  = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+        constexpr int prot  = PROT_READ | PROT_WRITE;
+        constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        void* data          = mmap(nullptr, rounded, prot, flags | MAP_HUGETLB, -1, 0);
+        if (data == MAP_FAILED) {
+            data = mmap(nullptr, rounded, prot, flags, -1, 0);
+            if (data != MAP_FAILED) {
+                madvise(data, rounded, MADV_HUGEPAGE);
+            }
+        }
+
+        if (data != MAP_FAILED) {
+            return {data, rounded, true};
+        }
+    }
+#else
+    static_cast<void>(huge_pages);
+#endif
+
+    return {::operator new(size, std::align_val_t{buffer_alignment}), size, false};
+}
+
+}  // namespace wwa
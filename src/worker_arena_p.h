@@ -0,0 +1,46 @@
+#ifndef EB3F3344_2435_4A9A_BA7A_B4C04A4AA878
+#define EB3F3344_2435_4A9A_BA7A_B4C04A4AA878
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+namespace wwa {
+
+// Scratch memory owned by a single worker slot; only the thread currently holding the slot may use it.
+// Allocations that do not fit into the buffer go to the default resource and are counted in `overflows`
+class worker_arena : public std::pmr::memory_resource {
+public:
+    worker_arena(std::size_t size, bool huge_pages, std::atomic<std::size_t>* overflows);
+    ~worker_arena() override;
+
+    worker_arena(const worker_arena&)            = delete;
+    worker_arena& operator=(const worker_arena&) = delete;
+    worker_arena(worker_arena&&)                 = delete;
+    worker_arena& operator=(worker_arena&&)      = delete;
+
+    void reset() noexcept { this->m_resource.release(); }
+    // Touches every page of the buffer, so that the first tasks do not pay for the page faults
+    void prefault() noexcept;
+
+private:
+    struct buffer {
+        void* data       = nullptr;
+        std::size_t size = 0;
+        bool mapped      = false;
+    };
+
+    buffer m_buffer;
+    std::pmr::monotonic_buffer_resource m_resource;
+    std::atomic<std::size_t>* m_overflows;
+
+    static buffer allocate(std::size_t size, bool huge_pages);
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+};
+
+}  // namespace wwa
+
+#endif /* EB3F3344_2435_4A9A_BA7A_B4C04A4AA878 */
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory_resource>
+#include <stop_token>
+#include <vector>
+
+#include "strand.h"
+#include "task_graph.h"
+#include "threadpool.h"
+
+TEST(ArenaTest, DefaultResourceOutsideTasks)
+{
+    EXPECT_EQ(wwa::this_worker::arena(), std::pmr::get_default_resource());
+
+    wwa::thread_pool pool(1);
+    std::pmr::memory_resource* arena = nullptr;
+    pool.submit([&arena](const std::stop_token&) { arena = wwa::this_worker::arena(); });
+    pool.wait();
+
+    // Arenas are off by default
+    EXPECT_EQ(arena, std::pmr::get_default_resource());
+    EXPECT_EQ(pool.arena_overflows(), 0);
+}
+
+TEST(ArenaTest, ResetAfterEachTask)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .arena_size = 4096});
+    std::vector<void*> blocks;
+
+    for (int i = 0; i < 3; ++i) {
+        pool.submit([&blocks](const std::stop_token&) {
+            auto* arena = wwa::this_worker::arena();
+            EXPECT_NE(arena, std::pmr::get_default_resource());
+
+            std::pmr::vector<int> v(arena);
+            v.reserve(256);
+            blocks.push_back(v.data());
+        });
+    }
+
+    pool.wait();
+    ASSERT_EQ(blocks.size(), 3);
+    EXPECT_EQ(blocks[0], blocks[1]);
+    EXPECT_EQ(blocks[1], blocks[2]);
+    EXPECT_EQ(pool.arena_overflows(), 0);
+}
+
+TEST(ArenaTest, ResetBetweenInlineTasks)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .arena_size = 4096});
+    std::vector<void*> blocks;
+
+    auto record = [&blocks](const std::stop_token&) {
+        blocks.push_back(wwa::this_worker::arena()->allocate(256));
+    };
+
+    // A strand runs its tasks in a single pool task, and a chain of graph nodes runs as continuations
+    wwa::strand strand(pool);
+    for (int i = 0; i < 3; ++i) {
+        strand.post(record);
+    }
+
+    pool.wait();
+
+    wwa::task_graph graph;
+    auto a = graph.add_node(record);
+    auto b = graph.add_node(record);
+    auto c = graph.add_node(record);
+    graph.add_edge(a, b);
+    graph.add_edge(b, c);
+    graph.run(pool);
+    graph.wait();
+
+    ASSERT_EQ(blocks.size(), 6);
+    for (const auto* block : blocks) {
+        EXPECT_EQ(block, blocks.front());
+    }
+}
+
+TEST(ArenaTest, CountsOverflows)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .arena_size = 1024});
+
+    pool.submit([](const std::stop_token&) {
+        auto* arena = wwa::this_worker::arena();
+        void* small = arena->allocate(512);
+        void* large = arena->allocate(8192);
+        EXPECT_NE(small, nullptr);
+        EXPECT_NE(large, nullptr);
+    });
+
+    pool.wait();
+    EXPECT_EQ(pool.arena_overflows(), 1);
+
+    // Every allocation served from outside the arena's buffer counts, not just the chunks taken from upstream
+    pool.submit([](const std::stop_token&) {
+        auto* arena = wwa::this_worker::arena();
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_NE(arena->allocate(512), nullptr);
+        }
+    });
+
+    pool.wait();
+    EXPECT_EQ(pool.arena_overflows(), 3);
+}
+
+TEST(ArenaTest, HugePages)
+{
+    const wwa::thread_pool::options opts{.num_threads = 2, .arena_size = 64 * 1024, .arena_huge_pages = true};
+    wwa::thread_pool pool(opts);
+
+    for (int i = 0; i < 8; ++i) {
+        pool.submit([](const std::stop_token&) {
+            std::pmr::vector<std::byte> buf(std::size_t{32} * 1024, std::byte{1}, wwa::this_worker::arena());
+            EXPECT_EQ(buf.back(), std::byte{1});
+        });
+    }
+
+    pool.wait();
+    EXPECT_EQ(pool.arena_overflows(), 0);
+}
+
+TEST(ArenaTest, SharedRuntime)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .shared_runtime = true, .arena_size = 4096});
+    std::pmr::memory_resource* arena = nullptr;
+    pool.submit([&arena](const std::stop_token&) { arena = wwa::this_worker::arena(); });
+    pool.wait();
+
+    EXPECT_NE(arena, nullptr);
+    EXPECT_NE(arena, std::pmr::get_default_resource());
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "basic_thread_pool.h"
+
+using minimal_pool = wwa::basic_thread_pool<wwa::fifo_queue, wwa::blocking_idle, wwa::no_stats, std::function<void()>>;
+using stats_pool   = wwa::basic_thread_pool<wwa::fifo_queue, wwa::blocking_idle, wwa::basic_stats>;
+
+static_assert(sizeof(minimal_pool) < sizeof(stats_pool), "no_stats must not take any space");
+
+TEST(BasicThreadPoolTest, DefaultConstruction)
+{
+    const wwa::basic_thread_pool<> pool;
+    EXPECT_EQ(pool.num_threads(), std::thread::hardware_concurrency());
+    EXPECT_EQ(pool.work_queue_size(), 0);
+}
+
+TEST(BasicThreadPoolTest, Fifo)
+{
+    constexpr auto NUM_TASKS = 10;
+    std::vector<int> expected(NUM_TASKS);
+    std::iota(expected.begin(), expected.end(), 0);
+    std::vector<int> results;
+
+    minimal_pool pool(1);
+    std::latch latch(1);
+    pool.submit([&latch] { latch.wait(); });
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        pool.submit([&results, i] { results.push_back(i); });
+    }
+
+    latch.count_down();
+    pool.wait();
+    EXPECT_EQ(results, expected);
+}
+
+TEST(BasicThreadPoolTest, Lifo)
+{
+    constexpr auto NUM_TASKS = 10;
+    std::vector<int> expected(NUM_TASKS);
+    std::iota(expected.rbegin(), expected.rend(), 0);
+    std::vector<int> results;
+
+    wwa::basic_thread_pool<wwa::lifo_queue> pool(1);
+    std::latch latch(1);
+    pool.submit([&latch](const std::stop_token&) { latch.wait(); });
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        pool.submit([&results, i](const std::stop_token&) { results.push_back(i); });
+    }
+
+    latch.count_down();
+    pool.wait();
+    EXPECT_EQ(results, expected);
+}
+
+TEST(BasicThreadPoolTest, SpinningIdleAndStats)
+{
+    constexpr auto NUM_THREADS = 4U;
+    constexpr auto NUM_TASKS   = 1000U;
+    std::atomic<unsigned int> counter{0};
+
+    wwa::basic_thread_pool<wwa::fifo_queue, wwa::spinning_idle<>, wwa::basic_stats> pool(NUM_THREADS);
+    for (auto i = 0U; i < NUM_TASKS; ++i) {
+        pool.submit([&counter](const std::stop_token&) { ++counter; });
+    }
+
+    pool.submit([](const std::stop_token&) { throw std::runtime_error("Task failed"); });
+    pool.wait();
+
+    EXPECT_EQ(counter, NUM_TASKS);
+    EXPECT_EQ(pool.stats().tasks_queued(), NUM_TASKS + 1U);
+    EXPECT_EQ(pool.stats().tasks_completed(), NUM_TASKS);
+    EXPECT_EQ(pool.stats().tasks_failed(), 1);
+    EXPECT_EQ(pool.stats().active_threads(), 0);
+    EXPECT_LE(pool.stats().max_active_threads(), NUM_THREADS);
+}
+
+TEST(BasicThreadPoolTest, DestructionStopsRunningTasks)
+{
+    std::latch latch(1);
+    std::atomic<bool> stopped{false};
+
+    {
+        wwa::basic_thread_pool<> pool(1);
+        pool.submit([&latch, &stopped](const std::stop_token& token) {
+            latch.count_down();
+            std::mutex m;
+            std::unique_lock<std::mutex> lock(m);
+            std::condition_variable_any().wait(lock, token, [] { return false; });
+            stopped = true;
+        });
+
+        pool.submit([](const std::stop_token&) { FAIL() << "Queued task must not run"; });
+        latch.wait();
+    }
+
+    EXPECT_TRUE(stopped);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <latch>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "threadpool.h"
+
+TEST(BatchTest, RunsAllTasks)
+{
+    constexpr std::size_t NUM_TASKS = 10000;
+
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 4, .max_batch = 16});
+    std::atomic<std::size_t> counter{0};
+
+    for (std::size_t i = 0; i < NUM_TASKS; ++i) {
+        pool.submit([&counter](const std::stop_token&) { ++counter; });
+    }
+
+    pool.wait();
+    EXPECT_EQ(counter, NUM_TASKS);
+    EXPECT_EQ(pool.tasks_completed(), NUM_TASKS);
+    EXPECT_EQ(pool.work_queue_size(), 0);
+    EXPECT_EQ(pool.active_threads(), 0);
+}
+
+TEST(BatchTest, IdleWorkersStealFromBuffers)
+{
+    constexpr std::size_t NUM_TASKS = 40;
+
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 2, .max_batch = 64});
+    std::latch gate(1);
+    std::latch gated(2);
+    std::latch release(1);
+    std::atomic<std::size_t> counter{0};
+
+    // Hold both workers so that the rest of the tasks pile up and get batched together with the blocker
+    for (int i = 0; i < 2; ++i) {
+        pool.submit([&gate, &gated](const std::stop_token&) {
+            gated.count_down();
+            gate.wait();
+        });
+    }
+
+    gated.wait();
+    pool.submit([&release](const std::stop_token&) { release.wait(); });
+    for (std::size_t i = 0; i < NUM_TASKS; ++i) {
+        pool.submit([&counter](const std::stop_token&) { ++counter; });
+    }
+
+    gate.count_down();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (counter != NUM_TASKS && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(counter, NUM_TASKS);
+    release.count_down();
+    pool.wait();
+}
+
+TEST(BatchTest, BufferedTasksCanBeCanceledAndReturned)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .max_batch = 8});
+    std::latch gate(1);
+    std::latch started(1);
+    std::vector<wwa::thread_pool::task_t> tasks;
+
+    pool.submit([&gate](const std::stop_token&) { gate.wait(); });
+    pool.submit([&started](const std::stop_token& token) {
+        started.count_down();
+        while (!token.stop_requested()) {
+            std::this_thread::yield();
+        }
+    });
+
+    for (int i = 0; i < 9; ++i) {
+        tasks.push_back(pool.submit([](const std::stop_token&) {}));
+    }
+
+    // The worker takes the blocking task and the next seven in one batch; two stay in the queue
+    gate.count_down();
+    started.wait();
+    EXPECT_EQ(pool.work_queue_size(), 9);
+
+    EXPECT_TRUE(pool.cancel(tasks.front()));
+    EXPECT_EQ(pool.work_queue_size(), 8);
+    EXPECT_EQ(pool.tasks_canceled(), 1);
+
+    const auto pending = pool.shutdown_now();
+    EXPECT_EQ(pending.size(), 8);
+    EXPECT_EQ(pool.work_queue_size(), 0);
+    pool.wait();
+}
+
+TEST(BatchTest, ShutdownNowWhileWorkersDrainBuffers)
+{
+    constexpr std::size_t NUM_TASKS = 2000;
+
+    for (int round = 0; round < 20; ++round) {
+        wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 4, .max_batch = 32});
+        std::atomic<std::size_t> counter{0};
+
+        for (std::size_t i = 0; i < NUM_TASKS; ++i) {
+            pool.submit([&counter](const std::stop_token&) { ++counter; });
+        }
+
+        const auto pending = pool.shutdown_now();
+
+        // The queue counters must not wrap around, or the pool would never look drained again
+        EXPECT_TRUE(pool.wait_for(std::chrono::seconds(5)));
+        EXPECT_EQ(pool.work_queue_size(), 0);
+        EXPECT_EQ(pool.load().queue_length, 0);
+        EXPECT_EQ(counter + pending.size(), NUM_TASKS);
+    }
+}
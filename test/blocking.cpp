@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <stop_token>
+#include <thread>
+
+#include "threadpool.h"
+
+TEST(BlockingTest, CompensatesBlockedWorker)
+{
+    wwa::thread_pool pool(1);
+    std::latch release(1);
+    std::atomic<std::size_t> blocked{0};
+
+    // With a single worker, the first task would wait forever for the second one without a spare
+    pool.submit([&release](const std::stop_token&) {
+        wwa::thread_pool::managed_block([&release] { release.wait(); });
+    });
+    pool.submit([&pool, &release, &blocked](const std::stop_token&) {
+        blocked = pool.blocked_threads();
+        release.count_down();
+    });
+
+    EXPECT_TRUE(pool.wait_for(std::chrono::seconds(5)));
+    EXPECT_EQ(blocked, 1);
+    EXPECT_EQ(pool.blocked_threads(), 0);
+    EXPECT_EQ(pool.tasks_completed(), 2);
+}
+
+TEST(BlockingTest, SpareThreadsAreCapped)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .max_spare_threads = 1});
+    std::latch started(2);
+    std::latch release(1);
+
+    for (int i = 0; i < 3; ++i) {
+        pool.submit([&started, &release](const std::stop_token&) {
+            const wwa::thread_pool::blocking_scope scope;
+            started.count_down();
+            release.wait();
+        });
+    }
+
+    started.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(pool.active_threads(), 2);
+    EXPECT_EQ(pool.blocked_threads(), 2);
+    EXPECT_EQ(pool.work_queue_size(), 1);
+
+    release.count_down();
+    pool.wait();
+    EXPECT_EQ(pool.tasks_completed(), 3);
+    EXPECT_EQ(pool.max_active_threads(), 2);
+}
+
+TEST(BlockingTest, NoOpOutsidePool)
+{
+    const wwa::thread_pool pool(1);
+    EXPECT_EQ(wwa::thread_pool::managed_block([] { return 42; }), 42);
+    EXPECT_EQ(pool.blocked_threads(), 0);
+}
+
+TEST(BlockingTest, SharedRuntime)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .shared_runtime = true});
+    std::latch release(1);
+
+    pool.submit([&release](const std::stop_token&) {
+        wwa::thread_pool::managed_block([&release] { release.wait(); });
+    });
+    pool.submit([&release](const std::stop_token&) { release.count_down(); });
+
+    EXPECT_TRUE(pool.wait_for(std::chrono::seconds(5)));
+    EXPECT_EQ(pool.blocked_threads(), 0);
+    EXPECT_EQ(pool.tasks_completed(), 2);
+}
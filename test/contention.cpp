@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stop_token>
+#include <thread>
+
+#include "threadpool.h"
+
+TEST(ContentionTest, CountsLocksAndWakeups)
+{
+    wwa::thread_pool pool(2);
+    constexpr auto NUM_TASKS = 100;
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        pool.submit([](const std::stop_token&) { std::this_thread::sleep_for(std::chrono::microseconds(10)); });
+    }
+
+    pool.wait();
+    const auto stats = pool.contention();
+    if (stats.lock_acquisitions == 0) {
+        GTEST_SKIP() << "Contention profiling is not compiled in";
+    }
+
+    EXPECT_EQ(stats.submissions, NUM_TASKS);
+    EXPECT_GE(stats.lock_acquisitions, 2 * NUM_TASKS);
+    EXPECT_LE(stats.contended_acquisitions, stats.lock_acquisitions);
+    EXPECT_GT(stats.lock_hold_time.count(), 0);
+    EXPECT_GE(stats.notifications, NUM_TASKS);
+    EXPECT_LE(stats.spurious_wakeups, stats.wakeups);
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <latch>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <utility>
+
+#include "file_ops.h"
+#include "threadpool.h"
+
+namespace {
+
+struct result {
+    std::int64_t value = 0;
+    bool canceled      = false;
+};
+
+}  // namespace
+
+class FileOpsTest : public ::testing::TestWithParam<bool> {
+protected:
+    void SetUp() override
+    {
+        const wwa::file_ops::options opts{.use_io_uring = GetParam()};
+        this->m_ops = std::make_unique<wwa::file_ops>(*this->m_pool, opts);
+        if (GetParam() && !this->m_ops->uses_io_uring()) {
+            GTEST_SKIP() << "io_uring is not available";
+        }
+
+        const char* tmpdir = std::getenv("TMPDIR");  // NOLINT(concurrency-mt-unsafe)
+        this->m_path       = std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/file_ops_XXXXXX";
+        const int fd       = mkstemp(this->m_path.data());
+        ASSERT_GE(fd, 0);
+        close(fd);
+    }
+
+    void TearDown() override
+    {
+        this->m_ops.reset();
+        if (!this->m_path.empty()) {
+            unlink(this->m_path.c_str());
+        }
+    }
+
+    template<typename F>
+    result run(F&& f)
+    {
+        result res;
+        std::latch done(1);
+        std::forward<F>(f)([&res, &done](std::int64_t value, bool canceled) {
+            res = {value, canceled};
+            done.count_down();
+        });
+
+        done.wait();
+        return res;
+    }
+
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    std::unique_ptr<wwa::thread_pool> m_pool = std::make_unique<wwa::thread_pool>(2);
+    std::unique_ptr<wwa::file_ops> m_ops;
+    std::string m_path;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+};
+
+TEST_P(FileOpsTest, WriteReadRoundTrip)
+{
+    const std::string data = "Hello, world!";
+    std::array<char, 64> buf{};
+
+    auto fd = this->run([this](auto cb) { this->m_ops->open(this->m_path.c_str(), O_RDWR, 0, cb); });
+    ASSERT_GE(fd.value, 0);
+    const auto descriptor = static_cast<int>(fd.value);
+
+    auto written = this->run([&](auto cb) { this->m_ops->write(descriptor, data.data(), data.size(), 0, cb); });
+    EXPECT_EQ(written.value, static_cast<std::int64_t>(data.size()));
+    EXPECT_FALSE(written.canceled);
+
+    auto synced = this->run([&](auto cb) { this->m_ops->fsync(descriptor, true, cb); });
+    EXPECT_EQ(synced.value, 0);
+
+    auto read = this->run([&](auto cb) { this->m_ops->read(descriptor, buf.data(), buf.size(), 7, cb); });
+    ASSERT_EQ(read.value, static_cast<std::int64_t>(data.size()) - 7);
+    EXPECT_EQ(std::string(buf.data(), static_cast<std::size_t>(read.value)), "world!");
+
+    struct ::stat st {};
+    auto stat = this->run([&](auto cb) { this->m_ops->stat(this->m_path.c_str(), &st, cb); });
+    EXPECT_EQ(stat.value, 0);
+    EXPECT_EQ(st.st_size, static_cast<off_t>(data.size()));
+    EXPECT_TRUE(S_ISREG(st.st_mode));
+
+    close(descriptor);
+}
+
+TEST_P(FileOpsTest, ErrorsAreNegativeErrno)
+{
+    const auto missing = this->m_path + ".missing";
+    auto fd            = this->run([&](auto cb) { this->m_ops->open(missing.c_str(), O_RDONLY, 0, cb); });
+    EXPECT_EQ(fd.value, -ENOENT);
+    EXPECT_FALSE(fd.canceled);
+
+    std::array<char, 16> buf{};
+    auto read = this->run([&](auto cb) { this->m_ops->read(-1, buf.data(), buf.size(), 0, cb); });
+    EXPECT_EQ(read.value, -EBADF);
+}
+
+TEST_P(FileOpsTest, StoppedTokenCancels)
+{
+    std::stop_source source;
+    source.request_stop();
+
+    const auto token = source.get_token();
+    auto fd          = this->run([&](auto cb) { this->m_ops->open(this->m_path.c_str(), O_RDONLY, 0, cb, token); });
+    EXPECT_EQ(fd.value, -ECANCELED);
+    EXPECT_TRUE(fd.canceled);
+}
+
+TEST_P(FileOpsTest, CancelInFlightRead)
+{
+    if (!GetParam()) {
+        GTEST_SKIP() << "A blocking read on a pool worker cannot be interrupted";
+    }
+
+    std::array<int, 2> fds{};
+    ASSERT_EQ(pipe(fds.data()), 0);
+
+    // Nothing is ever written to the pipe, so the read stays in flight until it is canceled
+    std::stop_source source;
+    std::array<char, 16> buf{};
+    result res;
+    std::latch done(1);
+    this->m_ops->read(
+        fds[0], buf.data(), buf.size(), 0,
+        [&res, &done](std::int64_t value, bool canceled) {
+            res = {value, canceled};
+            done.count_down();
+        },
+        source.get_token()
+    );
+
+    source.request_stop();
+    done.wait();
+    EXPECT_EQ(res.value, -ECANCELED);
+    EXPECT_TRUE(res.canceled);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_P(FileOpsTest, DestroyFromCompletion)
+{
+    std::array<int, 2> fds{};
+    ASSERT_EQ(pipe(fds.data()), 0);
+
+    std::array<char, 16> buf{};
+    struct ::stat st {};
+    result read;
+    std::latch read_done(1);
+    std::latch destroying(1);
+    std::latch destroyed(1);
+
+    // The read stays in flight until the destructor, called from the other completion, is waiting for it
+    this->m_ops->read(fds[0], buf.data(), buf.size(), 0, [&read, &read_done](std::int64_t value, bool canceled) {
+        read = {value, canceled};
+        read_done.count_down();
+    });
+
+    this->m_ops->stat(this->m_path.c_str(), &st, [this, &destroying, &destroyed](std::int64_t, bool) {
+        destroying.count_down();
+        this->m_ops.reset();
+        destroyed.count_down();
+    });
+
+    destroying.wait();
+    ASSERT_EQ(write(fds[1], "x", 1), 1);
+    read_done.wait();
+    destroyed.wait();
+    // `pread()` does not work on pipes; io_uring reads them as streams
+    EXPECT_EQ(read.value, GetParam() ? 1 : -ESPIPE);
+    EXPECT_FALSE(read.canceled);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Backends, FileOpsTest, ::testing::Values(false, true),
+    [](const ::testing::TestParamInfo<bool>& info) { return info.param ? "IoUring" : "Pool"; }
+);
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <latch>
+#include <cstddef>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "threadpool.h"
+
+using task_status = wwa::thread_pool::task_status;
+using task_handle = wwa::thread_pool::task_handle;
+
+static_assert(sizeof(task_handle) == 8);
+static_assert(std::is_trivially_copyable_v<task_handle>);
+
+TEST(HandleTest, PostRunsTask)
+{
+    wwa::thread_pool pool(1);
+    std::atomic<bool> ran{false};
+    std::atomic<bool> after{false};
+
+    const auto handle = pool.post(
+        [&ran](const std::stop_token&) { ran = true; }, [&after](bool canceled) { after = !canceled; }
+    );
+
+    pool.wait();
+    EXPECT_TRUE(ran);
+    EXPECT_TRUE(after);
+    EXPECT_EQ(pool.status(handle), task_status::done);
+    EXPECT_FALSE(pool.cancel(handle));
+    EXPECT_EQ(pool.tasks_completed(), 1);
+}
+
+TEST(HandleTest, CancelQueuedTask)
+{
+    wwa::thread_pool pool(1);
+    std::latch started(1);
+    std::latch release(1);
+    std::atomic<bool> ran{false};
+    std::atomic<bool> after{false};
+
+    const auto blocker = pool.post([&started, &release](const std::stop_token&) {
+        started.count_down();
+        release.wait();
+    });
+
+    started.wait();
+    const auto handle = pool.post([&ran](const std::stop_token&) { ran = true; }, [&after](bool) { after = true; });
+
+    EXPECT_EQ(pool.status(blocker), task_status::running);
+    EXPECT_EQ(pool.status(handle), task_status::queued);
+    EXPECT_TRUE(pool.cancel(handle));
+    EXPECT_FALSE(pool.cancel(handle));
+    EXPECT_EQ(pool.status(handle), task_status::canceled);
+
+    release.count_down();
+    pool.wait();
+    EXPECT_FALSE(ran);
+    EXPECT_FALSE(after);
+    EXPECT_EQ(pool.status(handle), task_status::canceled);
+    EXPECT_EQ(pool.tasks_canceled(), 1);
+    EXPECT_EQ(pool.tasks_completed(), 1);
+}
+
+TEST(HandleTest, CancelRunningTaskRequestsStop)
+{
+    wwa::thread_pool pool(1);
+    std::latch started(1);
+
+    const auto handle = pool.post([&started](const std::stop_token& token) {
+        started.count_down();
+        while (!token.stop_requested()) {
+            std::this_thread::yield();
+        }
+    });
+
+    started.wait();
+    EXPECT_FALSE(pool.cancel(handle));
+    pool.wait();
+    EXPECT_EQ(pool.status(handle), task_status::done);
+    EXPECT_EQ(pool.tasks_canceled(), 0);
+}
+
+TEST(HandleTest, StaleHandles)
+{
+    wwa::thread_pool pool(1);
+
+    EXPECT_EQ(pool.status(task_handle{}), task_status::unknown);
+    EXPECT_EQ(pool.status(task_handle{.index = 12345, .generation = 1}), task_status::unknown);
+    EXPECT_FALSE(pool.cancel(task_handle{.index = 12345, .generation = 1}));
+
+    const auto first = pool.post([](const std::stop_token&) {});
+    pool.wait();
+
+    // With a single slot in use at a time, the next task reuses it
+    const auto second = pool.post([](const std::stop_token&) {});
+    pool.wait();
+
+    ASSERT_EQ(second.index, first.index);
+    EXPECT_NE(second.generation, first.generation);
+    EXPECT_EQ(pool.status(first), task_status::unknown);
+    EXPECT_EQ(pool.status(second), task_status::done);
+    EXPECT_FALSE(pool.cancel(first));
+}
+
+TEST(HandleTest, CancelBufferedTask)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .max_batch = 8});
+    std::latch release(1);
+    std::atomic<int> ran{0};
+
+    pool.submit([&release](const std::stop_token&) { release.wait(); });
+    std::vector<task_handle> handles;
+    for (int i = 0; i < 16; ++i) {
+        handles.push_back(pool.post([&ran](const std::stop_token&) { ++ran; }));
+    }
+
+    for (std::size_t i = 0; i < handles.size(); i += 2) {
+        EXPECT_TRUE(pool.cancel(handles[i]));
+    }
+
+    release.count_down();
+    pool.wait();
+    EXPECT_EQ(ran, 8);
+    EXPECT_EQ(pool.tasks_canceled(), 8);
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        EXPECT_EQ(pool.status(handles[i]), (i % 2 == 0) ? task_status::canceled : task_status::done);
+    }
+}
+
+TEST(HandleTest, ShutdownNowSkipsCanceledTasks)
+{
+    wwa::thread_pool pool(1);
+    std::latch started(1);
+    std::latch release(1);
+
+    pool.submit([&started, &release](const std::stop_token&) {
+        started.count_down();
+        release.wait();
+    });
+
+    started.wait();
+    const auto canceled = pool.post([](const std::stop_token&) {});
+    const auto pending  = pool.post([](const std::stop_token&) {});
+    EXPECT_TRUE(pool.cancel(canceled));
+
+    const auto tasks = pool.shutdown_now();
+    release.count_down();
+    EXPECT_EQ(tasks.size(), 1);
+    EXPECT_EQ(pool.status(canceled), task_status::canceled);
+    EXPECT_EQ(pool.status(pending), task_status::canceled);
+}
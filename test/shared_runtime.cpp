@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <latch>
+#include <mutex>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "threadpool.h"
+
+namespace {
+
+const wwa::thread_pool::options shared_options{.num_threads = 0, .shared_runtime = true};
+
+}  // namespace
+
+TEST(SharedRuntimeTest, PoolsShareWorkers)
+{
+    constexpr std::size_t NUM_POOLS = 8;
+    constexpr std::size_t NUM_TASKS = 100;
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<std::size_t> counter{0};
+    std::size_t runtime_threads = 0;
+
+    {
+        std::vector<std::unique_ptr<wwa::thread_pool>> pools;
+        for (std::size_t i = 0; i < NUM_POOLS; ++i) {
+            pools.push_back(std::make_unique<wwa::thread_pool>(shared_options));
+        }
+
+        runtime_threads = pools.front()->num_threads();
+
+        for (auto& pool : pools) {
+            for (std::size_t i = 0; i < NUM_TASKS; ++i) {
+                pool->submit([&](const std::stop_token&) {
+                    ++counter;
+                    const std::scoped_lock<std::mutex> lock(mutex);
+                    threads.insert(std::this_thread::get_id());
+                });
+            }
+        }
+
+        for (auto& pool : pools) {
+            pool->wait();
+            EXPECT_EQ(pool->tasks_completed(), NUM_TASKS);
+            EXPECT_EQ(pool->num_threads(), std::thread::hardware_concurrency());
+        }
+    }
+
+    EXPECT_EQ(counter, NUM_POOLS * NUM_TASKS);
+    EXPECT_LE(threads.size(), runtime_threads);
+}
+
+TEST(SharedRuntimeTest, WaitIsScopedToThePool)
+{
+    if (std::thread::hardware_concurrency() < 2) {
+        GTEST_SKIP() << "The blocked task would occupy the only runtime worker";
+    }
+
+    wwa::thread_pool blocked(shared_options);
+    wwa::thread_pool other(shared_options);
+    std::latch started(1);
+    std::latch release(1);
+    std::atomic<bool> done{false};
+
+    blocked.submit([&started, &release](const std::stop_token&) {
+        started.count_down();
+        release.wait();
+    });
+
+    started.wait();
+    other.submit([&done](const std::stop_token&) { done = true; });
+    other.wait();
+
+    EXPECT_TRUE(done);
+    EXPECT_EQ(blocked.active_threads(), 1);
+
+    release.count_down();
+    blocked.wait();
+}
+
+TEST(SharedRuntimeTest, ConcurrencyLimit)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .shared_runtime = true});
+    std::atomic<int> in_flight{0};
+    std::atomic<bool> overlap{false};
+
+    for (int i = 0; i < 200; ++i) {
+        pool.submit([&in_flight, &overlap](const std::stop_token&) {
+            if (++in_flight != 1) {
+                overlap = true;
+            }
+
+            std::this_thread::yield();
+            --in_flight;
+        });
+    }
+
+    pool.wait();
+    EXPECT_FALSE(overlap);
+    EXPECT_EQ(pool.max_active_threads(), 1);
+    EXPECT_EQ(pool.tasks_completed(), 200);
+}
+
+TEST(SharedRuntimeTest, DestructionCancelsQueuedTasks)
+{
+    std::latch started(1);
+    std::atomic<int> canceled{0};
+    std::atomic<bool> stop_seen{false};
+
+    {
+        wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .shared_runtime = true});
+        pool.submit([&started, &stop_seen](const std::stop_token& token) {
+            started.count_down();
+            while (!token.stop_requested()) {
+                std::this_thread::yield();
+            }
+
+            stop_seen = true;
+        });
+
+        for (int i = 0; i < 5; ++i) {
+            pool.submit([](const std::stop_token&) {}, [&canceled](bool c) { canceled += c ? 1 : 0; });
+        }
+
+        started.wait();
+    }
+
+    EXPECT_TRUE(stop_seen);
+    EXPECT_EQ(canceled, 5);
+}
+
+TEST(SharedRuntimeTest, Shutdown)
+{
+    wwa::thread_pool pool(shared_options);
+    std::atomic<int> counter{0};
+
+    for (int i = 0; i < 50; ++i) {
+        pool.submit([&counter](const std::stop_token&) { ++counter; });
+    }
+
+    pool.shutdown();
+    EXPECT_EQ(counter, 50);
+    EXPECT_THROW(pool.submit([](const std::stop_token&) {}), std::runtime_error);
+}
@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <latch>
+#include <memory>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "strand.h"
+#include "threadpool.h"
+
+class StrandTest : public ::testing::Test {
+protected:
+    void SetUp() override { this->m_pool = std::make_unique<wwa::thread_pool>(StrandTest::NUM_THREADS); }
+
+    static constexpr auto NUM_THREADS = 4U;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    std::unique_ptr<wwa::thread_pool> m_pool;
+};
+
+TEST_F(StrandTest, SerialFifoExecution)
+{
+    constexpr std::size_t NUM_TASKS = 1000;
+
+    wwa::strand strand(*this->m_pool);
+    std::vector<std::size_t> order;
+    std::atomic<int> in_flight{0};
+    std::atomic<int> max_in_flight{0};
+
+    for (std::size_t i = 0; i < NUM_TASKS; ++i) {
+        strand.post([&, i](const std::stop_token&) {
+            const auto n = ++in_flight;
+            if (n > max_in_flight) {
+                max_in_flight = n;
+            }
+
+            order.push_back(i);
+            --in_flight;
+        });
+    }
+
+    this->m_pool->wait();
+
+    ASSERT_EQ(order.size(), NUM_TASKS);
+    for (std::size_t i = 0; i < NUM_TASKS; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+
+    EXPECT_EQ(max_in_flight, 1);
+}
+
+TEST_F(StrandTest, ConcurrentProducers)
+{
+    constexpr std::size_t NUM_PRODUCERS = 4;
+    constexpr std::size_t NUM_TASKS     = 500;
+
+    wwa::strand strand(*this->m_pool);
+    std::vector<std::vector<std::size_t>> seen(NUM_PRODUCERS);
+    std::atomic<int> in_flight{0};
+    std::atomic<bool> overlap{false};
+
+    {
+        std::vector<std::jthread> producers;
+        for (std::size_t p = 0; p < NUM_PRODUCERS; ++p) {
+            producers.emplace_back([&, p] {
+                for (std::size_t i = 0; i < NUM_TASKS; ++i) {
+                    strand.post([&, p, i](const std::stop_token&) {
+                        if (++in_flight != 1) {
+                            overlap = true;
+                        }
+
+                        seen[p].push_back(i);
+                        --in_flight;
+                    });
+                }
+            });
+        }
+    }
+
+    this->m_pool->wait();
+
+    EXPECT_FALSE(overlap);
+    for (const auto& v : seen) {
+        ASSERT_EQ(v.size(), NUM_TASKS);
+        for (std::size_t i = 0; i < NUM_TASKS; ++i) {
+            EXPECT_EQ(v[i], i);
+        }
+    }
+}
+
+TEST_F(StrandTest, StrandsRunInParallel)
+{
+    wwa::strand first(*this->m_pool);
+    wwa::strand second(*this->m_pool);
+    std::latch both(2);
+
+    // Each task waits for the other one: this only completes if the strands do not serialize each other
+    first.post([&both](const std::stop_token&) { both.arrive_and_wait(); });
+    second.post([&both](const std::stop_token&) { both.arrive_and_wait(); });
+
+    this->m_pool->wait();
+    EXPECT_TRUE(both.try_wait());
+}
+
+TEST_F(StrandTest, RunningInThisThread)
+{
+    wwa::strand first(*this->m_pool);
+    wwa::strand second(*this->m_pool);
+    std::atomic<bool> in_first{false};
+    std::atomic<bool> in_second{true};
+
+    EXPECT_FALSE(first.running_in_this_thread());
+
+    first.post([&](const std::stop_token&) {
+        in_first  = first.running_in_this_thread();
+        in_second = second.running_in_this_thread();
+    });
+
+    this->m_pool->wait();
+    EXPECT_TRUE(in_first);
+    EXPECT_FALSE(in_second);
+}
+
+TEST_F(StrandTest, ExceptionsDoNotStopTheStrand)
+{
+    wwa::strand strand(*this->m_pool);
+    std::atomic<int> after_work_calls{0};
+    std::atomic<bool> ran{false};
+
+    strand.post(
+        [](const std::stop_token&) { throw std::runtime_error("Task failed"); },
+        [&after_work_calls](bool canceled) {
+            EXPECT_FALSE(canceled);
+            ++after_work_calls;
+        }
+    );
+
+    strand.post([&ran](const std::stop_token&) { ran = true; });
+
+    this->m_pool->wait();
+    EXPECT_TRUE(ran);
+    EXPECT_EQ(after_work_calls, 1);
+    EXPECT_THROW(strand.post(nullptr), std::invalid_argument);
+}
+
+TEST_F(StrandTest, FailuresAreReportedToThePool)
+{
+    wwa::strand strand(*this->m_pool);
+    std::atomic<int> handled{0};
+    std::atomic<int> ran{0};
+
+    this->m_pool->set_error_handler([&handled](const std::exception_ptr&) { ++handled; });
+    for (int i = 0; i < 3; ++i) {
+        strand.post([](const std::stop_token&) { throw std::runtime_error("Task failed"); });
+        strand.post([&ran](const std::stop_token&) { ++ran; });
+    }
+
+    this->m_pool->wait();
+    EXPECT_EQ(ran, 3);
+    EXPECT_EQ(handled, 3);
+    EXPECT_EQ(this->m_pool->tasks_failed(), 3);
+    EXPECT_EQ(this->m_pool->recent_failures().size(), 3);
+}
+
+TEST(StrandCancelTest, PendingTasksAreCanceled)
+{
+    std::latch started(1);
+    std::atomic<int> canceled{0};
+    std::atomic<int> ran{0};
+
+    auto pool = std::make_unique<wwa::thread_pool>(1);
+    wwa::strand strand(*pool);
+
+    // Keep the only worker busy until the pool is destroyed so that the strand's pool task stays queued
+    pool->submit([&started](const std::stop_token& token) {
+        started.count_down();
+        while (!token.stop_requested()) {
+            std::this_thread::yield();
+        }
+    });
+
+    started.wait();
+    for (int i = 0; i < 3; ++i) {
+        strand.post([&ran](const std::stop_token&) { ++ran; }, [&canceled](bool c) { canceled += c ? 1 : 0; });
+    }
+
+    pool.reset();
+
+    EXPECT_EQ(ran, 0);
+    EXPECT_EQ(canceled, 3);
+}
+
+TEST(StrandCancelTest, DroppedShutdownNowResultCancelsTasks)
+{
+    std::latch started(1);
+    std::atomic<int> canceled{0};
+    std::atomic<int> ran{0};
+
+    wwa::thread_pool pool(1);
+    wwa::strand strand(pool);
+
+    pool.submit([&started](const std::stop_token& token) {
+        started.count_down();
+        while (!token.stop_requested()) {
+            std::this_thread::yield();
+        }
+    });
+
+    started.wait();
+    for (int i = 0; i < 3; ++i) {
+        strand.post([&ran](const std::stop_token&) { ++ran; }, [&canceled](bool c) { canceled += c ? 1 : 0; });
+    }
+
+    EXPECT_EQ(pool.shutdown_now().size(), 1);
+    EXPECT_EQ(canceled, 3);
+    EXPECT_THROW(strand.post([&ran](const std::stop_token&) { ++ran; }), std::runtime_error);
+
+    pool.wait();
+    EXPECT_EQ(ran, 0);
+}
+
+TEST(StrandCancelTest, AfterWorkOutlivesWorker)
+{
+    std::latch started(1);
+    std::atomic<int> canceled{0};
+
+    wwa::thread_pool pool(1);
+    auto strand = std::make_unique<wwa::strand>(pool);
+
+    pool.submit([&started](const std::stop_token& token) {
+        started.count_down();
+        while (!token.stop_requested()) {
+            std::this_thread::yield();
+        }
+    });
+
+    started.wait();
+    strand->post([](const std::stop_token&) {}, [&canceled](bool c) { canceled += c ? 1 : 0; });
+
+    auto pending = pool.shutdown_now();
+    ASSERT_EQ(pending.size(), 1);
+
+    // The pool task's callbacks keep the strand alive on their own, in whatever order the caller drops them
+    strand.reset();
+    pending.front().worker = nullptr;
+    pending.front().after_work(true);
+    EXPECT_EQ(canceled, 1);
+}
@@ -0,0 +1,239 @@
+// Scaling sweep: producers x workers x task duration. Prints one record per combination as CSV (default) or JSON;
+// exits with a non-zero status if any task is lost, so that it can double as a sanitizer smoke test.
+// Usage: stress_threadpool [--producers=1,2,4] [--workers=1,2,4,8] [--durations=0,1,10,100] [--tasks=20000]
+//                          [--format=csv|json]
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <map>
+#include <sstream>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "threadpool.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct config {
+    std::vector<std::size_t> producers{1, 2, 4};
+    std::vector<std::size_t> workers{1, 2, 4, 8};
+    std::vector<std::size_t> durations{0, 1, 10, 100};  // microseconds of busy work per task
+    std::size_t tasks = 20000;
+    bool json         = false;
+};
+
+struct result {
+    std::size_t producers = 0;
+    std::size_t workers   = 0;
+    std::size_t duration  = 0;
+    std::size_t tasks     = 0;
+    double seconds        = 0;
+    double throughput     = 0;   // tasks per second
+    double utilization    = 0;   // share of worker time spent in tasks
+    double efficiency     = -1;  // throughput over `workers` times the single-worker throughput; -1 if unknown
+    wwa::thread_pool::contention_stats contention;
+};
+
+std::vector<std::size_t> parse_list(std::string_view value)
+{
+    std::vector<std::size_t> list;
+    std::istringstream ss{std::string(value)};
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        list.push_back(std::strtoull(item.c_str(), nullptr, 10));
+    }
+
+    return list;
+}
+
+bool parse_args(int argc, char** argv, config& cfg)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto eq = arg.find('=');
+        if (!arg.starts_with("--") || eq == std::string_view::npos) {
+            return false;
+        }
+
+        const auto name  = arg.substr(2, eq - 2);
+        const auto value = arg.substr(eq + 1);
+        if (name == "producers") {
+            cfg.producers = parse_list(value);
+        }
+        else if (name == "workers") {
+            cfg.workers = parse_list(value);
+        }
+        else if (name == "durations") {
+            cfg.durations = parse_list(value);
+        }
+        else if (name == "tasks") {
+            cfg.tasks = std::strtoull(std::string(value).c_str(), nullptr, 10);
+        }
+        else if (name == "format" && (value == "csv" || value == "json")) {
+            cfg.json = value == "json";
+        }
+        else {
+            return false;
+        }
+    }
+
+    return cfg.tasks > 0;
+}
+
+void spin_for(std::chrono::microseconds duration)
+{
+    const auto until = clock_type::now() + duration;
+    while (clock_type::now() < until) {
+        // Busy work
+    }
+}
+
+bool run(std::size_t producers, std::size_t workers, std::size_t duration, std::size_t tasks, result& res)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = workers, .warm_up = true});
+    std::atomic<std::size_t> executed{0};
+    std::atomic<std::int64_t> busy_ns{0};
+    const auto task = [&executed, &busy_ns, duration](const std::stop_token&) {
+        const auto start = clock_type::now();
+        spin_for(std::chrono::microseconds(duration));
+        const auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start);
+        busy_ns.fetch_add(busy.count(), std::memory_order_relaxed);
+        executed.fetch_add(1U, std::memory_order_relaxed);
+    };
+
+    std::latch go(1);
+    std::vector<std::jthread> threads;
+    threads.reserve(producers);
+    for (std::size_t p = 0; p < producers; ++p) {
+        const auto count = tasks / producers + (p < tasks % producers ? 1 : 0);
+        threads.emplace_back([&pool, &go, &task, count] {
+            go.wait();
+            for (std::size_t i = 0; i < count; ++i) {
+                pool.submit(task);
+            }
+        });
+    }
+
+    const auto start = clock_type::now();
+    go.count_down();
+    threads.clear();
+    pool.wait();
+    const std::chrono::duration<double> elapsed = clock_type::now() - start;
+
+    res.producers   = producers;
+    res.workers     = workers;
+    res.duration    = duration;
+    res.tasks       = tasks;
+    res.seconds     = elapsed.count();
+    res.throughput  = static_cast<double>(tasks) / res.seconds;
+    res.utilization = static_cast<double>(busy_ns.load()) / 1e9 / (res.seconds * static_cast<double>(workers));
+    res.contention  = pool.contention();
+    return executed == tasks;
+}
+
+void print_csv(const std::vector<result>& results)
+{
+    std::printf(  // NOLINT(cppcoreguidelines-pro-type-vararg)
+        "producers,workers,duration_us,tasks,seconds,throughput,utilization,efficiency,lock_acquisitions,"
+        "contended_acquisitions,lock_wait_ns,lock_hold_ns,wakeups,spurious_wakeups,notifications_per_submit\n"
+    );
+
+    for (const auto& r : results) {
+        const auto& c = r.contention;
+        std::printf(  // NOLINT(cppcoreguidelines-pro-type-vararg)
+            "%zu,%zu,%zu,%zu,%.6f,%.1f,%.4f,%.4f,%llu,%llu,%lld,%lld,%llu,%llu,%.4f\n", r.producers, r.workers,
+            r.duration, r.tasks, r.seconds, r.throughput, r.utilization, r.efficiency,
+            static_cast<unsigned long long>(c.lock_acquisitions),
+            static_cast<unsigned long long>(c.contended_acquisitions),
+            static_cast<long long>(c.lock_wait_time.count()), static_cast<long long>(c.lock_hold_time.count()),
+            static_cast<unsigned long long>(c.wakeups), static_cast<unsigned long long>(c.spurious_wakeups),
+            c.submissions != 0 ? static_cast<double>(c.notifications) / static_cast<double>(c.submissions) : 0.0
+        );
+    }
+}
+
+void print_json(const std::vector<result>& results)
+{
+    std::printf("[");  // NOLINT(cppcoreguidelines-pro-type-vararg)
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        const auto& c = r.contention;
+        std::printf(  // NOLINT(cppcoreguidelines-pro-type-vararg)
+            R"(%s{"producers":%zu,"workers":%zu,"duration_us":%zu,"tasks":%zu,"seconds":%.6f,"throughput":%.1f,)"
+            R"("utilization":%.4f,"efficiency":%.4f,"lock_acquisitions":%llu,"contended_acquisitions":%llu,)"
+            R"("lock_wait_ns":%lld,"lock_hold_ns":%lld,"wakeups":%llu,"spurious_wakeups":%llu,)"
+            R"("notifications_per_submit":%.4f})",
+            i == 0 ? "\n" : ",\n", r.producers, r.workers, r.duration, r.tasks, r.seconds, r.throughput,
+            r.utilization, r.efficiency, static_cast<unsigned long long>(c.lock_acquisitions),
+            static_cast<unsigned long long>(c.contended_acquisitions),
+            static_cast<long long>(c.lock_wait_time.count()), static_cast<long long>(c.lock_hold_time.count()),
+            static_cast<unsigned long long>(c.wakeups), static_cast<unsigned long long>(c.spurious_wakeups),
+            c.submissions != 0 ? static_cast<double>(c.notifications) / static_cast<double>(c.submissions) : 0.0
+        );
+    }
+
+    std::printf("\n]\n");  // NOLINT(cppcoreguidelines-pro-type-vararg)
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    config cfg;
+    if (!parse_args(argc, argv, cfg)) {
+        std::fprintf(  // NOLINT(cppcoreguidelines-pro-type-vararg)
+            stderr, "Usage: %s [--producers=N,...] [--workers=N,...] [--durations=US,...] [--tasks=N] "
+                    "[--format=csv|json]\n",
+            argv[0]  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        );
+        return EXIT_FAILURE;
+    }
+
+    std::vector<result> results;
+    std::map<std::tuple<std::size_t, std::size_t>, double> baseline;  // (producers, duration) -> 1-worker throughput
+    bool ok = true;
+    for (const auto producers : cfg.producers) {
+        for (const auto duration : cfg.durations) {
+            for (const auto workers : cfg.workers) {
+                result res;
+                if (producers == 0 || workers == 0 || !run(producers, workers, duration, cfg.tasks, res)) {
+                    std::fprintf(  // NOLINT(cppcoreguidelines-pro-type-vararg)
+                        stderr, "Failed: %zu producers, %zu workers, %zu us\n", producers, workers, duration
+                    );
+                    ok = false;
+                    continue;
+                }
+
+                if (workers == 1) {
+                    baseline[{producers, duration}] = res.throughput;
+                }
+
+                if (const auto it = baseline.find({producers, duration}); it != baseline.end()) {
+                    res.efficiency = res.throughput / (it->second * static_cast<double>(workers));
+                }
+
+                results.push_back(res);
+            }
+        }
+    }
+
+    if (cfg.json) {
+        print_json(results);
+    }
+    else {
+        print_csv(results);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
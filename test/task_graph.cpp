@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "task_graph.h"
+#include "threadpool.h"
+
+const auto empty_task = [](const std::stop_token&) { /* Do nothing */ };
+
+class TaskGraphTest : public ::testing::Test {
+protected:
+    void SetUp() override { this->m_pool = std::make_unique<wwa::thread_pool>(TaskGraphTest::NUM_THREADS); }
+
+    static constexpr auto NUM_THREADS = 4U;
+    // NOLINTBEGIN(misc-non-private-member-variables-in-classes)
+    std::unique_ptr<wwa::thread_pool> m_pool;
+    std::vector<int> m_order;
+    std::mutex m_mutex;
+    // NOLINTEND(misc-non-private-member-variables-in-classes)
+
+    wwa::thread_pool::worker_t record(int value)
+    {
+        return [this, value](const std::stop_token&) {
+            const std::scoped_lock<std::mutex> lock(this->m_mutex);
+            this->m_order.push_back(value);
+        };
+    }
+};
+
+TEST_F(TaskGraphTest, EmptyGraph)
+{
+    wwa::task_graph graph;
+    graph.run(*this->m_pool);
+    graph.wait();
+    EXPECT_FALSE(graph.running());
+    EXPECT_EQ(graph.size(), 0);
+}
+
+TEST_F(TaskGraphTest, Dependencies)
+{
+    wwa::task_graph graph;
+
+    // 0 -> {1, 2} -> 3
+    auto a = graph.add_node(this->record(0));
+    auto b = graph.add_node(this->record(1));
+    auto c = graph.add_node(this->record(2));
+    auto d = graph.add_node(this->record(3));
+    graph.add_edge(a, b);
+    graph.add_edge(a, c);
+    graph.add_edge(b, d);
+    graph.add_edge(c, d);
+
+    graph.run(*this->m_pool);
+    graph.wait();
+
+    ASSERT_EQ(this->m_order.size(), 4);
+    EXPECT_EQ(this->m_order.front(), 0);
+    EXPECT_EQ(this->m_order.back(), 3);
+    EXPECT_EQ(graph.nodes_completed(), 4);
+    EXPECT_EQ(graph.nodes_failed(), 0);
+    EXPECT_EQ(graph.nodes_skipped(), 0);
+}
+
+TEST_F(TaskGraphTest, ContinuationRunsOnSameWorker)
+{
+    wwa::task_graph graph;
+    std::thread::id first;
+    std::thread::id second;
+
+    auto a = graph.add_node([&first](const std::stop_token&) { first = std::this_thread::get_id(); });
+    auto b = graph.add_node([&second](const std::stop_token&) { second = std::this_thread::get_id(); });
+    graph.add_edge(a, b);
+
+    graph.run(*this->m_pool);
+    graph.wait();
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(this->m_pool->tasks_queued(), 1);
+}
+
+TEST_F(TaskGraphTest, FailureSkipsDependents)
+{
+    wwa::task_graph graph;
+
+    // 0 (throws) -> 1 -> 2; 3 is independent
+    auto a = graph.add_node([](const std::stop_token&) { throw std::runtime_error("Node failed"); });
+    auto b = graph.add_node(this->record(1));
+    auto c = graph.add_node(this->record(2));
+    graph.add_node(this->record(3));
+    graph.add_edge(a, b);
+    graph.add_edge(b, c);
+
+    graph.run(*this->m_pool);
+    graph.wait();
+
+    EXPECT_EQ(this->m_order, std::vector<int>{3});
+    EXPECT_EQ(graph.nodes_completed(), 1);
+    EXPECT_EQ(graph.nodes_failed(), 1);
+    EXPECT_EQ(graph.nodes_skipped(), 2);
+    EXPECT_THROW(std::rethrow_exception(graph.exception()), std::runtime_error);
+}
+
+TEST_F(TaskGraphTest, Cancel)
+{
+    wwa::task_graph graph;
+    std::latch started(1);
+    std::atomic<bool> stop_seen{false};
+
+    auto a = graph.add_node([&started, &stop_seen](const std::stop_token& token) {
+        started.count_down();
+        while (!token.stop_requested()) {
+            std::this_thread::yield();
+        }
+
+        stop_seen = true;
+    });
+
+    auto b = graph.add_node(this->record(1));
+    graph.add_edge(a, b);
+
+    graph.run(*this->m_pool);
+    started.wait();
+    graph.cancel();
+    graph.wait();
+
+    EXPECT_TRUE(stop_seen);
+    EXPECT_TRUE(this->m_order.empty());
+    EXPECT_EQ(graph.nodes_skipped(), 1);
+}
+
+TEST_F(TaskGraphTest, PoolShutdownCancelsRun)
+{
+    wwa::task_graph graph;
+    std::latch started(1);
+    std::atomic<bool> stop_seen{false};
+
+    auto a = graph.add_node([&started, &stop_seen](const std::stop_token& token) {
+        started.count_down();
+        while (!token.stop_requested()) {
+            std::this_thread::yield();
+        }
+
+        stop_seen = true;
+    });
+
+    auto b = graph.add_node(this->record(1));
+    graph.add_edge(a, b);
+
+    graph.run(*this->m_pool);
+    started.wait();
+    EXPECT_TRUE(this->m_pool->shutdown_now().empty());
+    EXPECT_TRUE(graph.wait_for(std::chrono::seconds(5)));
+
+    EXPECT_TRUE(stop_seen);
+    EXPECT_TRUE(this->m_order.empty());
+    EXPECT_EQ(graph.nodes_completed(), 1);
+    EXPECT_EQ(graph.nodes_skipped(), 1);
+}
+
+TEST(TaskGraphShutdownTest, DroppedPendingNodeIsSkipped)
+{
+    wwa::task_graph graph;
+    std::latch started(1);
+    std::atomic<int> ran{0};
+
+    graph.add_node([&started](const std::stop_token& token) {
+        started.count_down();
+        while (!token.stop_requested()) {
+            std::this_thread::yield();
+        }
+    });
+
+    auto b = graph.add_node([&ran](const std::stop_token&) { ++ran; });
+    auto c = graph.add_node([&ran](const std::stop_token&) { ++ran; });
+    graph.add_edge(b, c);
+
+    wwa::thread_pool pool(1);
+    graph.run(pool);
+    started.wait();
+
+    // The second root is still queued; dropping the returned task must not leave the run hanging
+    EXPECT_EQ(pool.shutdown_now().size(), 1);
+    EXPECT_TRUE(graph.wait_for(std::chrono::seconds(5)));
+    EXPECT_FALSE(graph.running());
+    EXPECT_EQ(ran, 0);
+    EXPECT_EQ(graph.nodes_skipped(), 2);
+}
+
+TEST_F(TaskGraphTest, Reuse)
+{
+    wwa::task_graph graph;
+    std::atomic<int> counter{0};
+
+    auto a = graph.add_node([&counter](const std::stop_token&) { ++counter; });
+    auto b = graph.add_node([&counter](const std::stop_token&) { ++counter; });
+    graph.add_edge(a, b);
+
+    constexpr auto NUM_RUNS = 10;
+    for (int i = 0; i < NUM_RUNS; ++i) {
+        graph.run(*this->m_pool);
+        EXPECT_TRUE(graph.wait_for(std::chrono::seconds(5)));
+    }
+
+    EXPECT_EQ(counter, 2 * NUM_RUNS);
+    EXPECT_EQ(graph.nodes_completed(), 2);
+}
+
+TEST_F(TaskGraphTest, InvalidGraphs)
+{
+    wwa::task_graph graph;
+    auto a = graph.add_node(empty_task);
+    auto b = graph.add_node(empty_task);
+
+    EXPECT_THROW(graph.add_node(nullptr), std::invalid_argument);
+    EXPECT_THROW(graph.add_edge(a, a), std::invalid_argument);
+    EXPECT_THROW(graph.add_edge(a, 2), std::out_of_range);
+
+    graph.add_edge(a, b);
+    graph.add_edge(b, a);
+    EXPECT_THROW(graph.run(*this->m_pool), std::logic_error);
+}
+
+TEST_F(TaskGraphTest, ModifyWhileRunning)
+{
+    wwa::task_graph graph;
+    std::latch release(1);
+
+    graph.add_node([&release](const std::stop_token&) { release.wait(); });
+    graph.run(*this->m_pool);
+
+    EXPECT_THROW(graph.add_node(empty_task), std::logic_error);
+    EXPECT_THROW(graph.run(*this->m_pool), std::logic_error);
+
+    release.count_down();
+    graph.wait();
+}
+
+TEST(TaskGraphDestructionTest, PoolDestroyedBeforeRun)
+{
+    wwa::task_graph graph;
+    std::latch started(1);
+    std::latch release(1);
+
+    graph.add_node([&started, &release](const std::stop_token&) {
+        started.count_down();
+        release.wait();
+    });
+
+    auto b = graph.add_node(empty_task);
+    auto c = graph.add_node(empty_task);
+    auto d = graph.add_node(empty_task);
+    graph.add_edge(b, c);
+    graph.add_edge(c, d);
+
+    {
+        const std::jthread releaser([&release] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            release.count_down();
+        });
+
+        wwa::thread_pool pool(1);
+        graph.run(pool);
+        started.wait();
+    }
+
+    graph.wait();
+    EXPECT_EQ(graph.nodes_completed(), 1);
+    EXPECT_EQ(graph.nodes_skipped(), 3);
+}
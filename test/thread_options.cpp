@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory_resource>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef __linux__
+#    include <pthread.h>
+#endif
+
+#include "threadpool.h"
+
+#ifdef __linux__
+namespace {
+
+// Counts the threads of this process whose name starts with `prefix`
+std::size_t thread_count(const std::string& prefix)
+{
+    std::size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task")) {
+        std::ifstream comm(entry.path() / "comm");
+        std::string name;
+        if (std::getline(comm, name) && name.starts_with(prefix)) {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+}  // namespace
+
+TEST(ThreadOptionsTest, WorkersStartOnDemand)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 8, .thread_name = "lazy"});
+    EXPECT_EQ(thread_count("lazy-"), 0);
+    EXPECT_EQ(pool.num_threads(), 8);
+
+    pool.submit([](const std::stop_token&) {});
+    pool.wait();
+    EXPECT_EQ(thread_count("lazy-"), 1);
+
+    // An idle worker is reused rather than joined by a new one
+    pool.submit([](const std::stop_token&) {});
+    pool.wait();
+    EXPECT_EQ(thread_count("lazy-"), 1);
+}
+
+TEST(ThreadOptionsTest, WarmUpStartsAllWorkers)
+{
+    const wwa::thread_pool::options opts{
+        .num_threads = 4, .arena_size = 64 * 1024, .warm_up = true, .thread_name = "warm"
+    };
+    wwa::thread_pool pool(opts);
+    EXPECT_EQ(thread_count("warm-"), 4);
+
+    pool.submit([](const std::stop_token&) {
+        std::pmr::vector<char> buf(32 * 1024, 'x', wwa::this_worker::arena());
+        EXPECT_EQ(buf.back(), 'x');
+    });
+
+    pool.wait();
+    EXPECT_EQ(thread_count("warm-"), 4);
+    EXPECT_EQ(pool.arena_overflows(), 0);
+}
+
+TEST(ThreadOptionsTest, ThreadNames)
+{
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 1, .thread_name = "tp-test"});
+    std::array<char, 16> name{};
+
+    pool.submit([&name](const std::stop_token&) { pthread_getname_np(pthread_self(), name.data(), name.size()); });
+    pool.wait();
+    EXPECT_EQ(std::string(name.data()), "tp-test-0");
+}
+
+TEST(ThreadOptionsTest, StackSize)
+{
+    constexpr std::size_t stack_size = std::size_t{1} << 20U;
+    const wwa::thread_pool::options opts{.num_threads = 1, .warm_up = true, .stack_size = stack_size};
+    wwa::thread_pool pool(opts);
+    std::size_t actual = 0;
+
+    pool.submit([&actual](const std::stop_token&) {
+        pthread_attr_t attr;
+        ASSERT_EQ(pthread_getattr_np(pthread_self(), &attr), 0);
+        pthread_attr_getstacksize(&attr, &actual);
+        pthread_attr_destroy(&attr);
+    });
+
+    pool.wait();
+    EXPECT_GE(actual, stack_size);
+    EXPECT_LT(actual, 2 * stack_size);
+}
+
+TEST(ThreadOptionsTest, ThreadCreationFailure)
+{
+    // No system can map a stack this large, so `pthread_create()` fails
+    constexpr std::size_t stack_size = std::size_t{1} << 46U;
+
+    const wwa::thread_pool::options warm{.num_threads = 2, .warm_up = true, .stack_size = stack_size};
+    EXPECT_THROW(wwa::thread_pool{warm}, std::system_error);
+
+    // Without a single worker to run it, the task is rejected
+    wwa::thread_pool pool(wwa::thread_pool::options{.num_threads = 2, .stack_size = stack_size});
+    EXPECT_THROW(pool.submit([](const std::stop_token&) {}), std::system_error);
+    EXPECT_EQ(pool.work_queue_size(), 0);
+}
+#endif
@@ -1,6 +1,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <exception>
@@ -151,3 +152,200 @@ TEST(ArgumentValidityTest, SubmitNullWorker)
     wwa::thread_pool pool;
     EXPECT_THROW(pool.submit(nullptr), std::invalid_argument);
 }
+
+TEST_F(ThreadPoolTest, Load)
+{
+    this->m_pool->set_load_window(std::chrono::milliseconds(20));
+
+    auto load = this->m_pool->load();
+    EXPECT_EQ(load.utilization, 0);
+    EXPECT_EQ(load.queue_length, 0);
+
+    std::latch latch(ThreadPoolTest::NUM_THREADS);
+    std::binary_semaphore sem{0};
+    for (auto i = 0U; i < ThreadPoolTest::NUM_THREADS * 2U; ++i) {
+        this->m_pool->submit([&latch, &sem](const std::stop_token&) {
+            latch.count_down();
+            sem.acquire();
+            sem.release();
+        });
+    }
+
+    latch.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    load = this->m_pool->load();
+    EXPECT_GT(load.utilization, 0.9);
+    EXPECT_GT(load.arrival_rate, 0);
+    EXPECT_EQ(load.completion_rate, 0);
+    EXPECT_EQ(load.queue_length, ThreadPoolTest::NUM_THREADS);
+
+    sem.release();
+    this->m_pool->wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    load = this->m_pool->load();
+    EXPECT_LT(load.utilization, 0.1);
+    EXPECT_EQ(load.queue_length, 0);
+    EXPECT_THROW(this->m_pool->set_load_window(std::chrono::seconds(0)), std::invalid_argument);
+}
+
+TEST_F(ThreadPoolTest, Shutdown)
+{
+    std::atomic<unsigned int> counter{0};
+    constexpr auto NUM_TASKS = ThreadPoolTest::NUM_THREADS * 4U;
+
+    for (auto i = 0U; i < NUM_TASKS; ++i) {
+        this->m_pool->submit([&counter, this](const std::stop_token&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            // Follow-up work submitted by the pool's own tasks is still accepted while draining
+            this->m_pool->submit([&counter](const std::stop_token&) { ++counter; });
+            ++counter;
+        });
+    }
+
+    this->m_pool->shutdown();
+
+    EXPECT_EQ(counter, NUM_TASKS * 2U);
+    EXPECT_EQ(this->m_pool->tasks_completed(), NUM_TASKS * 2U);
+    EXPECT_THROW(this->m_pool->submit(empty_task), std::runtime_error);
+}
+
+TEST_F(ThreadPoolTest, ShutdownNow)
+{
+    std::latch latch(ThreadPoolTest::NUM_THREADS);
+    std::atomic<unsigned int> stopped{0};
+
+    for (auto i = 0U; i < ThreadPoolTest::NUM_THREADS; ++i) {
+        this->m_pool->submit([&latch, &stopped](const std::stop_token& token) {
+            latch.count_down();
+            std::mutex m;
+            std::unique_lock<std::mutex> lock(m);
+            std::condition_variable_any().wait(lock, token, [] { return false; });
+            ++stopped;
+        });
+    }
+
+    constexpr auto NUM_PENDING = 5U;
+    int invoked                = 0;
+    for (auto i = 0U; i < NUM_PENDING; ++i) {
+        this->m_pool->submit([&invoked](const std::stop_token&) { ++invoked; });
+    }
+
+    latch.wait();
+    auto pending = this->m_pool->shutdown_now();
+    this->m_pool->wait();
+
+    EXPECT_EQ(pending.size(), NUM_PENDING);
+    EXPECT_EQ(stopped, ThreadPoolTest::NUM_THREADS);
+    EXPECT_EQ(this->m_pool->work_queue_size(), 0);
+    EXPECT_THROW(this->m_pool->submit(empty_task), std::runtime_error);
+
+    for (const auto& task : pending) {
+        task.worker(std::stop_token());
+    }
+
+    EXPECT_EQ(invoked, NUM_PENDING);
+}
+
+TEST_F(ThreadPoolTest, ShutdownFor)
+{
+    std::latch latch(ThreadPoolTest::NUM_THREADS);
+    std::atomic<unsigned int> canceled{0};
+
+    for (auto i = 0U; i < ThreadPoolTest::NUM_THREADS; ++i) {
+        this->m_pool->submit([&latch](const std::stop_token& token) {
+            latch.count_down();
+            std::mutex m;
+            std::unique_lock<std::mutex> lock(m);
+            std::condition_variable_any().wait(lock, token, [] { return false; });
+        });
+    }
+
+    constexpr auto NUM_PENDING = 100U;
+    for (auto i = 0U; i < NUM_PENDING; ++i) {
+        this->m_pool->submit(empty_task, [&canceled](bool was_canceled) {
+            if (was_canceled) {
+                ++canceled;
+            }
+        });
+    }
+
+    latch.wait();
+    EXPECT_FALSE(this->m_pool->shutdown_for(std::chrono::milliseconds(10)));
+    this->m_pool->wait();
+
+    EXPECT_EQ(canceled, NUM_PENDING);
+    EXPECT_EQ(this->m_pool->tasks_canceled(), NUM_PENDING);
+    EXPECT_EQ(this->m_pool->tasks_completed(), ThreadPoolTest::NUM_THREADS);
+}
+
+TEST_F(ThreadPoolTest, ShutdownForDrained)
+{
+    this->m_pool->submit(empty_task);
+    EXPECT_TRUE(this->m_pool->shutdown_for(std::chrono::seconds(5)));
+    EXPECT_EQ(this->m_pool->tasks_completed(), 1);
+}
+
+TEST_F(ThreadPoolTest, ErrorHandler)
+{
+    std::mutex mutex;
+    std::vector<std::exception_ptr> errors;
+    int after_work_has_exception = -1;
+
+    this->m_pool->set_error_handler([&mutex, &errors](const std::exception_ptr& e) {
+        const std::scoped_lock<std::mutex> lock(mutex);
+        errors.push_back(e);
+    });
+
+    this->m_pool->submit([](const std::stop_token&) { throw std::runtime_error("Task failed"); });
+    this->m_pool->submit(
+        // NOLINTNEXTLINE(hicpp-exception-baseclass)
+        [](const std::stop_token&) { throw 42; },
+        [&after_work_has_exception](bool) {
+            after_work_has_exception = (std::current_exception() != nullptr) ? 1 : 0;
+        }
+    );
+    this->m_pool->submit(empty_task);
+    this->m_pool->wait();
+
+    EXPECT_EQ(this->m_pool->tasks_failed(), 2);
+    EXPECT_EQ(this->m_pool->tasks_completed(), 1);
+    EXPECT_EQ(after_work_has_exception, 1);
+    ASSERT_EQ(errors.size(), 2);
+
+    const auto failures = this->m_pool->recent_failures();
+    ASSERT_EQ(failures.size(), 2);
+
+    int ints = 0;
+    for (const auto& failure : failures) {
+        try {
+            std::rethrow_exception(failure.exception);
+        }
+        catch (int) {
+            ++ints;
+        }
+        catch (const std::runtime_error&) {
+            // Expected
+        }
+    }
+
+    EXPECT_EQ(ints, 1);
+
+    this->m_pool->set_error_handler(nullptr);
+    this->m_pool->submit([](const std::stop_token&) { throw std::runtime_error("Task failed"); });
+    this->m_pool->wait();
+    EXPECT_EQ(errors.size(), 2);
+}
+
+TEST_F(ThreadPoolTest, RecentFailuresAreBounded)
+{
+    constexpr auto NUM_TASKS = 100U;
+    for (auto i = 0U; i < NUM_TASKS; ++i) {
+        this->m_pool->submit([](const std::stop_token&) { throw std::runtime_error("Task failed"); });
+    }
+
+    this->m_pool->wait();
+    EXPECT_EQ(this->m_pool->tasks_failed(), NUM_TASKS);
+    EXPECT_EQ(this->m_pool->recent_failures().size(), 64);
+}
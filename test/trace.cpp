@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stop_token>
+#include <string>
+
+#include "threadpool.h"
+
+const auto empty_task = [](const std::stop_token&) { /* Do nothing */ };
+
+TEST(TraceTest, DisabledByDefault)
+{
+    const wwa::thread_pool pool(1);
+    EXPECT_FALSE(pool.tracing_enabled());
+
+    std::ostringstream os;
+    pool.dump_trace(os);
+    EXPECT_NE(os.str().find(R"("traceEvents":[)"), std::string::npos);
+    EXPECT_EQ(os.str().find(R"("ph":"B")"), std::string::npos);
+}
+
+TEST(TraceTest, RecordsTaskLifecycle)
+{
+    wwa::thread_pool pool(2);
+    pool.enable_tracing();
+    if (!pool.tracing_enabled()) {
+        GTEST_SKIP() << "Tracing support is not compiled in";
+    }
+
+    constexpr auto NUM_TASKS = 10;
+    for (int i = 0; i < NUM_TASKS; ++i) {
+        pool.submit(empty_task);
+    }
+
+    pool.wait();
+    pool.enable_tracing(false);
+    pool.submit(empty_task);
+    pool.wait();
+
+    std::ostringstream os;
+    pool.dump_trace(os);
+    const auto trace = os.str();
+
+    auto count = [&trace](const std::string& needle) {
+        std::size_t n   = 0;
+        std::size_t pos = 0;
+        while ((pos = trace.find(needle, pos)) != std::string::npos) {
+            ++n;
+            pos += needle.size();
+        }
+
+        return n;
+    };
+
+    EXPECT_EQ(trace.front(), '{');
+    EXPECT_EQ(trace.back(), '}');
+    EXPECT_EQ(count(R"("name":"submit")"), NUM_TASKS);
+    EXPECT_EQ(count(R"("name":"dequeue")"), NUM_TASKS);
+    EXPECT_EQ(count(R"("ph":"B")"), NUM_TASKS);
+    EXPECT_EQ(count(R"("ph":"E")"), NUM_TASKS);
+    EXPECT_EQ(count(R"("name":"worker 0")"), 1);
+    EXPECT_EQ(count(R"("name":"external")"), 1);
+}